@@ -36,6 +36,20 @@
 #define D6  GPIO_PIN_6
 #define D7  GPIO_PIN_7
 
+// Panel size. Change these for a 20x4 (or 16x4) display.
+#define LCD_SATIR   2   // Rows
+#define LCD_SUTUN   16  // Columns
+
+// DDRAM address where each row starts. All these panels use a 2-line
+// controller: on 4-row panels rows 3 and 4 are the second half of lines 1 and 2.
+#if LCD_SATIR == 4 && LCD_SUTUN == 20
+const unsigned char satir_adres[4] = { 0x00, 0x40, 0x14, 0x54 }; // 20x4
+#elif LCD_SATIR == 4
+const unsigned char satir_adres[4] = { 0x00, 0x40, 0x10, 0x50 }; // 16x4
+#else
+const unsigned char satir_adres[2] = { 0x00, 0x40 };             // 16x2, 20x2
+#endif
+
 // Global variable for delay duration (50,000 loop cycles)
 long sure = 50000;
 
@@ -126,24 +140,19 @@ void komut_yaz(void)
 //===========================================================================
 // FUNCTION: satir_sutun (Row_Column)
 // Moves the cursor to a specific location.
-// satir = Row (1 or 2), sutun = Column (1 to 16)
+// satir = Row (1 to LCD_SATIR), sutun = Column (1 to LCD_SUTUN)
 //===========================================================================
 void satir_sutun(unsigned char satir, unsigned char sutun)
 {
 
-    char total;
+    unsigned char total;
 
     // Calculate the memory address for the cursor.
-    // Row 1 starts at address 0x00 (0x80 command + 0x00).
-    // Row 2 starts at address 0x40 (0x80 command + 0x40 = 0xC0).
-
-    // If Row 1: Base becomes 0x7F (because 0x7F + 1 = 0x80 command start)
-    if(satir == 1) { satir = 0x7F; }
-    // If Row 2: Base becomes 0xBF (because 0xBF + 1 = 0xC0 command start)
-    if(satir == 2) { satir = 0x0BF; }
-
-    // Add the column number to find exact position
-    total = satir + sutun;
+    // 0x80 is the "set address" command, satir_adres[] holds where each
+    // row starts (Row 1 = 0x00, Row 2 = 0x40, on 20x4: Row 3 = 0x14, Row 4 = 0x54).
+    // Rows and columns start at 1 here, so subtract 1 from both.
+    if (satir < 1 || satir > LCD_SATIR) { satir = 1; }
+    total = 0x80 + satir_adres[satir - 1] + (sutun - 1);
 
     // Reset control pins to 0 (Command Mode)
     GPIOPinWrite(GPIO_PORTE_BASE, RS | RW | EN, 0x00);
@@ -39,6 +39,12 @@
 #define LCD_CMD_FUNCTION_SET 0x28 // 4-bit data, 2-line display, 5x8 font
 #define LCD_CMD_SET_DDRAM   0x80 // Command to set cursor position
 
+// Panel size and the DDRAM address where each row starts.
+// For a 20x4 panel: LCD_ROWS 4, LCD_COLS 20 and { 0x00, 0x40, 0x14, 0x54 }.
+#define LCD_ROWS            2
+#define LCD_COLS            16
+const uint8_t g_ui8RowAddr[LCD_ROWS] = { 0x00, 0x40 };
+
 // ============================================================================
 //                             GLOBAL VARIABLES
 // ============================================================================
@@ -125,14 +131,12 @@ void LCD_PrintString(char *str)
 }
 
 // 6. SET CURSOR
-// col = 0-15, row = 0-1
+// col = 0..LCD_COLS-1, row = 0..LCD_ROWS-1
 void LCD_SetCursor(uint8_t col, uint8_t row)
 {
-    // Base command is 0x80
-    uint8_t cmd = LCD_CMD_SET_DDRAM + col;
-    // If row is 1 (the second line), add offset 0x40
-    if (row == 1)
-        cmd += 0x40;
+    // Base command is 0x80, plus where the row starts, plus the column
+    if (row >= LCD_ROWS) row = 0;
+    uint8_t cmd = LCD_CMD_SET_DDRAM + g_ui8RowAddr[row] + col;
 
     LCD_Send_Cmd(cmd);
 }
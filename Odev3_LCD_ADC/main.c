@@ -48,6 +48,23 @@ volatile uint32_t g_ui32Seconds = 0;  // Stores the current Second
 // False = No new time. True = Time has changed, update the screen!
 volatile bool g_bUpdateScreen = true;
 
+// --- Display Frame Buffers (see DOUBLE-BUFFERED DISPLAY below) ---
+// Panel size. For a 20x4 panel use 4 / 20 and the 20x4 row addresses below.
+#define LCD_ROWS 2
+#define LCD_COLS 16
+
+// DDRAM address where each row starts (16x2: 0x00, 0x40; 20x4: 0x00, 0x40, 0x14, 0x54)
+const uint8_t g_ui8RowAddr[LCD_ROWS] = { 0x00, 0x40 };
+char g_frames[2][LCD_ROWS][LCD_COLS];   // Two complete screens of characters
+char (*g_front)[LCD_COLS] = g_frames[0]; // Screen being sent to the LCD
+char (*g_back)[LCD_COLS] = g_frames[1];  // Screen being prepared by the program
+int g_iSendPos = -1;                     // Next cell of the front screen (-1 = nothing to send)
+bool g_bBackReady = false;               // Back screen is finished and waits for the swap
+
+// Counters (watch them in the debugger)
+uint32_t g_ui32FramesShown = 0;   // Screens sent to the LCD
+uint32_t g_ui32FramesDropped = 0; // Screens skipped because the LCD was still busy
+
 // ============================================================================
 //                           HELPER FUNCTIONS
 // ============================================================================
@@ -134,9 +151,10 @@ void LCD_Init(void) {
 // Function to move the cursor to a specific spot
 void LCD_SetCursor(uint8_t col, uint8_t row) {
     // 0x80 is the base command for cursor position.
-    // If row is 1, we add 0x40 (the address of the second line).
+    // g_ui8RowAddr[] says where the row starts (row 1 = 0x40, on 20x4 also 0x14 / 0x54).
     // Then we add 'col' to move sideways.
-    LCD_Send_Byte(0x80 + (row * 0x40) + col, false);
+    if (row >= LCD_ROWS) row = 0;
+    LCD_Send_Byte(0x80 + g_ui8RowAddr[row] + col, false);
 }
 
 // Function to print a string of text
@@ -148,6 +166,63 @@ void LCD_Print(char *str) {
     }
 }
 
+// ============================================================================
+//                        DOUBLE-BUFFERED DISPLAY
+// ============================================================================
+// Writing the whole screen takes ~3 ms of waiting. Doing that right after the
+// ADC read meant the next reading had to wait for the LCD, and a slow read
+// delayed the screen. Now the two are separate:
+//   - The program writes the next screen into the BACK buffer (RAM only, fast).
+//   - Frame_Poll() sends the FRONT buffer, ONE character per main loop pass.
+//   - When the front screen is complete, the buffers swap (frame boundary).
+// If a new screen is ready before the LCD has taken the previous one, the
+// new screen is dropped (and counted); the next second brings fresh data.
+
+// Starts a new screen. Returns false if the back buffer is still waiting.
+bool Frame_Begin(void) {
+    if (g_bBackReady) {
+        g_ui32FramesDropped++;
+        return false;
+    }
+    return true;
+}
+
+// Copies a text line into the back buffer, padded with spaces
+void Frame_Text(int row, const char *str) {
+    int col;
+    for (col = 0; col < LCD_COLS; col++) {
+        g_back[row][col] = *str ? *str++ : ' ';
+    }
+}
+
+// Marks the back screen as finished
+void Frame_End(void) {
+    g_bBackReady = true;
+}
+
+// Sends one character of the front screen (call it in every loop pass)
+void Frame_Poll(void) {
+    char (*swap)[LCD_COLS];
+    int row, col;
+
+    if (g_iSendPos < 0) {
+        // Front screen is complete: take the next one if there is one
+        if (!g_bBackReady) return;
+        swap = g_front; g_front = g_back; g_back = swap;
+        g_bBackReady = false;
+        g_iSendPos = 0;
+        g_ui32FramesShown++;
+    }
+
+    row = g_iSendPos / LCD_COLS;
+    col = g_iSendPos % LCD_COLS;
+    if (col == 0) LCD_SetCursor(0, row); // Start of a line
+    LCD_Send_Byte(g_front[row][col], true);
+
+    // Move to the next cell, stop after the last one
+    if (++g_iSendPos == LCD_ROWS * LCD_COLS) g_iSendPos = -1;
+}
+
 // ============================================================================
 //                         TIMER INTERRUPT (THE CLOCK)
 // ============================================================================
@@ -265,21 +340,26 @@ int main(void) {
             // Immediately reset the flag to false
             g_bUpdateScreen = false;
 
-            // Read the current sensor value
+            // Read the current sensor value (never waits for the LCD)
             uint32_t adc_val = Read_ADC();
 
-            // --- Write Line 1 ---
-            LCD_SetCursor(0, 0);       // Move to Top Left
-            LCD_Print("BARAA HOSSREH  "); // Print Name
+            // Prepare the next screen in the back buffer (RAM only)
+            if (Frame_Begin()) {
+                // --- Line 1 ---
+                Frame_Text(0, "BARAA HOSSREH"); // Print Name
 
-            // --- Write Line 2 ---
-            // Format the string nicely:
-            // %02d puts a leading zero if number < 10 (e.g., "05")
-            // %4d reserves 4 spaces for the ADC value
-            sprintf(buffer, "%02d:%02d:%02d A:%4d", g_ui32Hours, g_ui32Minutes, g_ui32Seconds, adc_val);
+                // --- Line 2 ---
+                // Format the string nicely:
+                // %02d puts a leading zero if number < 10 (e.g., "05")
+                // %4d reserves 4 spaces for the ADC value
+                sprintf(buffer, "%02d:%02d:%02d A:%4d", g_ui32Hours, g_ui32Minutes, g_ui32Seconds, adc_val);
+                Frame_Text(1, buffer);
 
-            LCD_SetCursor(0, 1);       // Move to Bottom Left
-            LCD_Print(buffer);         // Print the time string
+                Frame_End();
+            }
         }
+
+        // Send one character of the current screen to the LCD
+        Frame_Poll();
     }
 }
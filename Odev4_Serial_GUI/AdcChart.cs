@@ -0,0 +1,214 @@
+using System;
+using System.Drawing;
+using System.Globalization;
+using System.Windows.Forms;
+
+namespace MicrocontrollerProject
+{
+    // Fixed-capacity sample history with a min/max pyramid.
+    //
+    // Level 0 is the raw ring of samples. Level k stores min/max of blocks of
+    // 2^k samples and is filled as samples arrive (amortized O(1) per sample).
+    // A pixel column covering S samples reads level floor(log2(S)), i.e. one
+    // or two blocks, so drawing a frame costs O(width) no matter how many
+    // samples are buffered. Memory is allocated once in the constructor.
+    public sealed class MinMaxHistory
+    {
+        readonly int capacity;      // Power of two
+        readonly int levels;
+        readonly ushort[] raw;      // Level 0
+        readonly ushort[][] min, max; // Levels 1..levels-1
+        long count;                 // Samples ever added
+
+        public MinMaxHistory(int capacityLog2)
+        {
+            capacity = 1 << capacityLog2;
+            levels = capacityLog2 + 1;
+            raw = new ushort[capacity];
+            min = new ushort[levels][];
+            max = new ushort[levels][];
+            for (int k = 1; k < levels; k++) {
+                min[k] = new ushort[capacity >> k];
+                max[k] = new ushort[capacity >> k];
+            }
+        }
+
+        public int Capacity { get { return capacity; } }
+        public long Count { get { return count; } }
+        public long Oldest { get { return Math.Max(0, count - capacity); } }
+
+        public void Add(int value)
+        {
+            ushort v = (ushort)Math.Max(0, Math.Min(ushort.MaxValue, value));
+            long n = count;
+            raw[n & (capacity - 1)] = v;
+
+            // Close every block that this sample completes
+            for (int k = 1; k < levels && ((n + 1) & ((1L << k) - 1)) == 0; k++) {
+                long j = n >> k;              // Block index at level k
+                int mask = (capacity >> k) - 1;
+                ushort lo, hi;
+                if (k == 1) {
+                    ushort a = raw[(2 * j) & (capacity - 1)], b = raw[(2 * j + 1) & (capacity - 1)];
+                    lo = Math.Min(a, b); hi = Math.Max(a, b);
+                } else {
+                    int pm = (capacity >> (k - 1)) - 1;
+                    lo = Math.Min(min[k - 1][(2 * j) & pm], min[k - 1][(2 * j + 1) & pm]);
+                    hi = Math.Max(max[k - 1][(2 * j) & pm], max[k - 1][(2 * j + 1) & pm]);
+                }
+                min[k][j & mask] = lo;
+                max[k][j & mask] = hi;
+            }
+            count = n + 1;
+        }
+
+        public int this[long i] { get { return raw[i & (capacity - 1)]; } }
+
+        // Min/max over samples [from, to). Block edges are rounded to the level
+        // used, which is below one pixel at the zoom that picked that level.
+        public bool MinMax(long from, long to, out int lo, out int hi)
+        {
+            lo = int.MaxValue; hi = int.MinValue;
+            from = Math.Max(from, Oldest);
+            to = Math.Min(to, count);
+            if (to <= from) return false;
+
+            int k = 0;
+            while (k + 1 < levels && (2L << k) <= to - from) k++;
+
+            if (k == 0) {
+                for (long i = from; i < to; i++) { int v = this[i]; if (v < lo) lo = v; if (v > hi) hi = v; }
+                return true;
+            }
+
+            long firstBlock = from >> k;
+            long lastBlock = (to >> k) - 1;           // Last complete block inside the range
+            long completeBlocks = count >> k;         // Blocks closed so far
+            int mask = (capacity >> k) - 1;
+            for (long j = firstBlock; j <= lastBlock && j < completeBlocks; j++) {
+                if (min[k][j & mask] < lo) lo = min[k][j & mask];
+                if (max[k][j & mask] > hi) hi = max[k][j & mask];
+            }
+            // Newest samples that do not fill a level-k block yet: the range is
+            // shorter than one block, so the recursion picks a finer level
+            long tail = Math.Max(from, completeBlocks << k);
+            int tlo, thi;
+            if (tail < to && MinMax(tail, to, out tlo, out thi)) {
+                lo = Math.Min(lo, tlo);
+                hi = Math.Max(hi, thi);
+            }
+            return lo <= hi;
+        }
+    }
+
+    // Kayan ADC grafiği.
+    //   Tekerlek       : yakınlaştır / uzaklaştır (ekrandaki örnek sayısı)
+    //   Boşluk / tık   : durdur / devam (durunca sürükleyerek geçmişe bakılır)
+    public class AdcChart : Control
+    {
+        public readonly MinMaxHistory History = new MinMaxHistory(22); // 4M samples, ~24 MB
+        public int MaxValue = 4095;
+
+        long viewSamples = 600;   // Samples across the plot width
+        bool paused;
+        long pausedEnd;           // Right edge while paused
+        int dragX = -1;
+        long dragEnd;
+        bool moved;
+
+        public AdcChart()
+        {
+            DoubleBuffered = true;
+            BackColor = Color.Black;
+            ForeColor = Color.LimeGreen;
+        }
+
+        public bool Paused
+        {
+            get { return paused; }
+            set { paused = value; pausedEnd = History.Count; Invalidate(); }
+        }
+
+        public void Add(int value)
+        {
+            History.Add(value);
+        }
+
+        protected override void OnPaint(PaintEventArgs e)
+        {
+            Graphics g = e.Graphics;
+            g.Clear(BackColor);
+            int w = Width, h = Height - 16;
+            if (w <= 0 || h <= 0) return;
+
+            long right = paused ? pausedEnd : History.Count;
+            long left = right - viewSamples;
+
+            using (Pen grid = new Pen(Color.FromArgb(40, 40, 40)))
+                for (int i = 1; i < 4; i++) g.DrawLine(grid, 0, h * i / 4, w, h * i / 4);
+
+            using (Pen pen = new Pen(ForeColor)) {
+                int prevLo = -1, prevHi = -1;
+                for (int x = 0; x < w; x++) {
+                    long a = left + viewSamples * x / w;
+                    long b = left + viewSamples * (x + 1) / w;
+                    if (b <= a) b = a + 1;
+                    int lo, hi;
+                    if (!History.MinMax(a, b, out lo, out hi)) { prevLo = -1; continue; }
+
+                    int y0 = Y(hi, h), y1 = Y(lo, h);
+                    // Join with the previous column so steep edges stay connected
+                    if (prevLo >= 0) { y0 = Math.Min(y0, prevLo); y1 = Math.Max(y1, prevHi); }
+                    g.DrawLine(pen, x, y0, x, Math.Max(y1, y0 + 1));
+                    prevLo = Y(lo, h); prevHi = Y(hi, h);
+                }
+            }
+
+            string info = string.Format(CultureInfo.InvariantCulture, "{0} samples/screen  {1} buffered{2}",
+                viewSamples, Math.Min(History.Count, History.Capacity), paused ? "  [PAUSED]" : "");
+            if (History.Count > 0) info += "  last: " + History[History.Count - 1];
+            using (Brush b = new SolidBrush(Color.Silver))
+                g.DrawString(info, Font, b, 2, h + 1);
+        }
+
+        int Y(int v, int h)
+        {
+            return h - 1 - (int)((long)Math.Max(0, Math.Min(MaxValue, v)) * (h - 1) / MaxValue);
+        }
+
+        protected override void OnMouseWheel(MouseEventArgs e)
+        {
+            viewSamples = (e.Delta > 0) ? viewSamples / 2 : viewSamples * 2;
+            viewSamples = Math.Max(16, Math.Min(History.Capacity, viewSamples));
+            Invalidate();
+        }
+
+        protected override void OnMouseDown(MouseEventArgs e)
+        {
+            Focus();
+            dragX = e.X;
+            dragEnd = pausedEnd;
+            moved = false;
+        }
+
+        protected override void OnMouseMove(MouseEventArgs e)
+        {
+            if (dragX < 0 || !paused || Width == 0) return;
+            moved = true;
+            pausedEnd = dragEnd - (e.X - dragX) * viewSamples / Width;
+            pausedEnd = Math.Max(History.Oldest + viewSamples / 2, Math.Min(History.Count, pausedEnd));
+            Invalidate();
+        }
+
+        protected override void OnMouseUp(MouseEventArgs e)
+        {
+            if (dragX >= 0 && !moved) Paused = !paused; // Plain click toggles pause
+            dragX = -1;
+        }
+
+        protected override void OnKeyDown(KeyEventArgs e)
+        {
+            if (e.KeyCode == Keys.Space) { Paused = !paused; e.Handled = true; }
+        }
+    }
+}
@@ -0,0 +1,54 @@
+using System;
+using System.IO.Ports;
+using System.Net;
+using System.Threading;
+
+namespace MicrocontrollerProject
+{
+    // Seri port -> TCP köprüsü (konsol uygulaması).
+    // Build: dotnet build Bridge/SerialBridge.csproj (compiles this file with
+    // ../TelemetryPipeline.cs, ../ClockSync.cs, ../TelemetryLog.cs and ../SerialBridge.cs).
+    //
+    //   SerialBridge COM3 [baud=9600] [tcp port=5760] [--any]
+    //
+    // Listens on localhost only unless --any is given.
+    static class BridgeMain
+    {
+        static int Main(string[] args)
+        {
+            if (args.Length < 1) {
+                Console.WriteLine("usage: SerialBridge <port> [baud] [tcp port] [--any]");
+                return 1;
+            }
+            int baud = (args.Length > 1) ? int.Parse(args[1]) : 9600;
+            int tcpPort = (args.Length > 2 && args[2] != "--any") ? int.Parse(args[2]) : 5760;
+            IPAddress bind = (Array.IndexOf(args, "--any") >= 0) ? IPAddress.Any : IPAddress.Loopback;
+
+            SerialPort port = new SerialPort(args[0], baud, Parity.None, 8, StopBits.One);
+            port.Open();
+
+            using (SerialBridge bridge = new SerialBridge(port.BaseStream, new IPEndPoint(bind, tcpPort))) {
+                bridge.Log = msg => Console.WriteLine(DateTime.Now.ToString("HH:mm:ss ") + msg);
+                bridge.Start();
+                Console.WriteLine("{0} @ {1} -> {2} (Ctrl+C to stop)", args[0], baud, bridge.LocalEndpoint);
+
+                ManualResetEvent quit = new ManualResetEvent(false);
+                Console.CancelKeyPress += (s, e) => { e.Cancel = true; quit.Set(); };
+
+                while (!quit.WaitOne(10000)) {
+                    TelemetryPipeline p = bridge.Pipeline;
+                    long dropped = 0;
+                    foreach (BridgeClient c in bridge.Clients) dropped += c.Dropped;
+                    bridge.Log(string.Format("rx {0} B, {1} msgs, {2} clients, {3} client drops, {4} cmds ({5} dropped), {6} bad lines",
+                        p.BytesRead, bridge.Messages, bridge.Clients.Count, dropped, bridge.CommandsForwarded, bridge.CommandsDropped, p.BadLines));
+                    if (p.LastError != null) {
+                        bridge.Log("device error: " + p.LastError.Message);
+                        break;
+                    }
+                }
+            }
+            port.Close();
+            return 0;
+        }
+    }
+}
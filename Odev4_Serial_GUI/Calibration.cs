@@ -0,0 +1,217 @@
+using System;
+using System.Drawing;
+using System.Globalization;
+using System.Windows.Forms;
+
+namespace MicrocontrollerProject
+{
+    // PC side of the 'K' command (calib.h). A table holds the calibrated
+    // value at raw 0, 256 ... 4096; conversion is the same integer
+    // interpolation the device does, so both show the same number.
+    public sealed class CalTable
+    {
+        public const int Shift = 8, Step = 1 << Shift, Points = 4096 / Step + 1, UnitMax = 4;
+        public const int ValueMax = 999999999; // CAL_VALUE_MAX
+
+        public int Channel;
+        public int Decimals;
+        public string Unit = "mV";
+        public int[] Values = new int[Points];
+
+        // Same as cal_default in calib.h (millivolts at 3.3 V)
+        public static CalTable Default()
+        {
+            CalTable t = new CalTable();
+            for (int i = 0; i < Points; i++) t.Values[i] = (i * Step * 3300 + 2047) / 4095;
+            return t;
+        }
+
+        // Same integer math as Cal_Two_Point(); null if the line leaves +-ValueMax
+        public static CalTable TwoPoint(int r0, int v0, int r1, int v1)
+        {
+            CalTable t = new CalTable();
+            for (int i = 0; i < Points; i++) {
+                long v = v0 + (long)(i * Step - r0) * ((long)v1 - v0) / (r1 - r0);
+                if (v > ValueMax || v < -ValueMax) return null;
+                t.Values[i] = (int)v;
+            }
+            return t;
+        }
+
+        // Same as Cal_Convert()
+        public int Convert(int raw)
+        {
+            int i = raw >> Shift, f = raw & (Step - 1);
+            if (i >= Points - 1) return Values[Points - 1];
+            return Values[i] + (int)((((long)Values[i + 1] - Values[i]) * f) >> Shift);
+        }
+
+        public string Format(int raw)
+        {
+            int v = Convert(raw);
+            if (Decimals == 0) return v.ToString(CultureInfo.InvariantCulture) + " " + Unit;
+            decimal d = v / (decimal)Math.Pow(10, Decimals);
+            return d.ToString("F" + Decimals, CultureInfo.InvariantCulture) + " " + Unit;
+        }
+
+        // "K;<ch>;<dec>;<unit>;<v0>,...,<v16>" from the device; null if not one
+        public static CalTable Parse(string line)
+        {
+            if (!line.StartsWith("K;")) return null;
+            string[] f = line.Split(';');
+            if (f.Length != 5) return null;
+            CalTable t = new CalTable();
+            string[] v = f[4].Split(',');
+            if (!int.TryParse(f[1], out t.Channel) || !int.TryParse(f[2], out t.Decimals) || v.Length != Points) return null;
+            t.Unit = f[3];
+            for (int i = 0; i < Points; i++)
+                if (!int.TryParse(v[i], NumberStyles.AllowLeadingSign, CultureInfo.InvariantCulture, out t.Values[i])) return null;
+            return t;
+        }
+
+        // Commands that put this table on the device
+        public string[] Commands()
+        {
+            string ch = Channel.ToString(CultureInfo.InvariantCulture);
+            return new string[] {
+                "K" + ch + "P" + string.Join(",", Array.ConvertAll(Values, x => x.ToString(CultureInfo.InvariantCulture))) + "\n",
+                "K" + ch + "U" + Decimals.ToString(CultureInfo.InvariantCulture) + "," + Unit + "\n"
+            };
+        }
+    }
+
+    // Kalibrasyon penceresi: iki nokta veya 17 noktalı tablo, birim ve ondalık
+    public class CalibrationForm : Form
+    {
+        readonly TextBox txtPoints = new TextBox(), txtTable = new TextBox(), txtUnit = new TextBox(), txtDec = new TextBox();
+        readonly Label lblPreview = new Label();
+        readonly Action<string> send;
+        readonly Action<CalTable> apply;
+
+        // send writes a command, apply tells the main window the new table
+        public CalibrationForm(Action<string> send, Action<CalTable> apply, CalTable current)
+        {
+            this.send = send;
+            this.apply = apply;
+            Text = "ADC Calibration";
+            Size = new Size(560, 300);
+
+            TableLayoutPanel grid = new TableLayoutPanel();
+            grid.Dock = DockStyle.Fill;
+            grid.ColumnCount = 3;
+
+            txtPoints.Width = 220;
+            txtPoints.Text = "0,0,4095,3300";
+            AddRow(grid, "Two points (raw,value,raw,value)", txtPoints, "Send two-point", BtnTwoPointClick);
+
+            txtTable.Width = 220;
+            txtTable.Text = string.Join(",", current.Values);
+            AddRow(grid, "Table (17 values, raw 0..4096)", txtTable, "Send table", BtnTableClick);
+
+            txtUnit.Width = 60;
+            txtUnit.Text = current.Unit;
+            txtDec.Width = 40;
+            txtDec.Text = current.Decimals.ToString();
+            AddRow(grid, "Unit", txtUnit, null, null);
+            AddRow(grid, "Decimals (0-3)", txtDec, "Reset to mV", BtnResetClick);
+
+            lblPreview.AutoSize = true;
+            grid.Controls.Add(lblPreview);
+            grid.SetColumnSpan(lblPreview, 3);
+            Controls.Add(grid);
+            ShowPreview(current);
+        }
+
+        static void AddRow(TableLayoutPanel grid, string label, TextBox box, string button, EventHandler click)
+        {
+            Label l = new Label();
+            l.Text = label;
+            l.AutoSize = true;
+            l.Anchor = AnchorStyles.Left;
+            grid.Controls.Add(l);
+            grid.Controls.Add(box);
+            if (button == null) { grid.Controls.Add(new Label()); return; }
+            Button b = new Button();
+            b.Text = button;
+            b.AutoSize = true;
+            b.Click += click;
+            grid.Controls.Add(b);
+        }
+
+        // Unit and decimals from the form; false (with a message) if invalid
+        bool ReadUnit(CalTable t)
+        {
+            string unit = txtUnit.Text.Trim();
+            if (!int.TryParse(txtDec.Text, out t.Decimals) || t.Decimals < 0 || t.Decimals > 3
+                || unit.Length > CalTable.UnitMax || unit.IndexOfAny(new[] { ';', ',', '\r', '\n' }) >= 0) {
+                MessageBox.Show("Decimals must be 0..3, unit at most 4 characters.");
+                return false;
+            }
+            t.Unit = unit;
+            return true;
+        }
+
+        static int[] ParseInts(string text, int count)
+        {
+            string[] f = text.Split(',');
+            if (f.Length != count) return null;
+            int[] v = new int[count];
+            for (int i = 0; i < count; i++)
+                if (!int.TryParse(f[i].Trim(), NumberStyles.AllowLeadingSign, CultureInfo.InvariantCulture, out v[i])) return null;
+            return v;
+        }
+
+        void BtnTwoPointClick(object sender, EventArgs e)
+        {
+            int[] p = ParseInts(txtPoints.Text, 4);
+            if (p == null || p[0] == p[2] || p[0] < 0 || p[0] > 4095 || p[2] < 0 || p[2] > 4095) {
+                MessageBox.Show("Enter raw0,value0,raw1,value1 with two different raw counts (0..4095).");
+                return;
+            }
+            CalTable t = CalTable.TwoPoint(p[0], p[1], p[2], p[3]);
+            if (t == null || Math.Abs((long)p[1]) > CalTable.ValueMax || Math.Abs((long)p[3]) > CalTable.ValueMax) {
+                MessageBox.Show("Values must stay within +-999999999 everywhere between raw 0 and 4096.");
+                return;
+            }
+            if (!ReadUnit(t)) return;
+            txtTable.Text = string.Join(",", t.Values);
+            Upload(t);
+        }
+
+        void BtnTableClick(object sender, EventArgs e)
+        {
+            int[] v = ParseInts(txtTable.Text, CalTable.Points);
+            if (v == null || Array.Exists(v, x => x > CalTable.ValueMax || x < -CalTable.ValueMax)) {
+                MessageBox.Show("The table needs 17 whole numbers (at most 9 digits) separated by commas.");
+                return;
+            }
+            CalTable t = new CalTable();
+            t.Values = v;
+            if (!ReadUnit(t)) return;
+            Upload(t);
+        }
+
+        void BtnResetClick(object sender, EventArgs e)
+        {
+            CalTable t = CalTable.Default();
+            txtTable.Text = string.Join(",", t.Values);
+            txtUnit.Text = t.Unit;
+            txtDec.Text = "0";
+            send("K0R");
+            apply(t);
+            ShowPreview(t);
+        }
+
+        void Upload(CalTable t)
+        {
+            foreach (string c in t.Commands()) send(c);
+            apply(t);
+            ShowPreview(t);
+        }
+
+        void ShowPreview(CalTable t)
+        {
+            lblPreview.Text = "raw 0 = " + t.Format(0) + ",  2048 = " + t.Format(2048) + ",  4095 = " + t.Format(4095);
+        }
+    }
+}
@@ -0,0 +1,143 @@
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+
+namespace MicrocontrollerProject
+{
+    // Maps device Micros() to the PC's Stopwatch clock.
+    //
+    // The PC sends 'Q' and the device answers "Q;<micros>" at once. Assuming
+    // the request and the reply spend the same time in flight, the device
+    // read its clock halfway through the round trip. The reply's own line
+    // time at the current baud rate is subtracted first because it is only
+    // on the return path. Of the last few probes the one with the shortest
+    // round trip wins (least queuing, e.g. when the device was busy sending
+    // a report); re-probing every second keeps crystal drift (~50 ppm) well
+    // below a millisecond.
+    public sealed class ClockSync
+    {
+        struct Probe { public long HostTicks; public uint DeviceUs; public double RttUs; }
+
+        const int Window = 10;
+        readonly double ticksPerUs = Stopwatch.Frequency / 1e6;
+        readonly Queue<Probe> probes = new Queue<Probe>();
+        readonly object sync = new object();
+        long sentTicks;      // 0 = no probe outstanding
+        Probe best;
+
+        public int BaudRate = 9600;
+        public bool Synced { get; private set; }
+
+        // Uncertainty of the mapping (half the best round trip), microseconds
+        public double ErrorUs { get { lock (sync) return best.RttUs / 2; } }
+
+        // Call right before writing "Q" to the port
+        public void BeginProbe()
+        {
+            lock (sync) sentTicks = Stopwatch.GetTimestamp();
+        }
+
+        // Pipeline hook: consumes "Q;<micros>" lines
+        internal bool TryReply(byte[] b, int off, int len, long rxTicks)
+        {
+            if (len < 3 || b[off] != 'Q' || b[off + 1] != ';') return false;
+            int pos = off + 2;
+            long us;
+            if (!TelemetryParser.Number(b, ref pos, off + len, out us)) return true;
+
+            lock (sync) {
+                if (sentTicks == 0) return true; // Nobody asked (or a late duplicate)
+                double lineUs = (len + 1) * 10 * 1e6 / BaudRate; // Reply bytes incl. '\n', 10 bits each
+                double rttUs = Math.Max(0, (rxTicks - sentTicks) / ticksPerUs - lineUs);
+                Probe p = new Probe();
+                p.HostTicks = sentTicks + (long)(rttUs / 2 * ticksPerUs);
+                p.DeviceUs = (uint)us;
+                p.RttUs = rttUs;
+                sentTicks = 0;
+
+                probes.Enqueue(p);
+                if (probes.Count > Window) probes.Dequeue();
+                best = p;
+                foreach (Probe q in probes) if (q.RttUs < best.RttUs) best = q;
+                Synced = true;
+            }
+            return true;
+        }
+
+        // Device Micros() -> Stopwatch ticks. The signed 32-bit difference
+        // handles Micros() wrapping as long as the stamps are near the probe.
+        public long ToHostTicks(uint deviceUs)
+        {
+            lock (sync) return best.HostTicks + (long)((int)(deviceUs - best.DeviceUs) * ticksPerUs);
+        }
+    }
+
+    // Rolling percentiles for the report path, one row per stage
+    public sealed class LatencyStats
+    {
+        public static readonly string[] Stages = {
+            "Timer tick -> ADC",       // Main loop picking up the tick
+            "ADC -> TX start",         // Formatting the report
+            "TX start -> PC read",     // UART line time + driver/USB buffering (needs sync)
+            "PC read -> parsed",       // Pipeline queue + parse
+            "Parsed -> shown",         // UI frame wait + paint
+            "ADC -> shown (total)",    // Needs sync
+        };
+        public const int TickToAdc = 0, AdcToTx = 1, Wire = 2, Parse = 3, Ui = 4, Total = 5;
+
+        const int Window = 1024;
+        readonly double[][] values = new double[Stages.Length][];
+        readonly int[] count = new int[Stages.Length];
+        readonly double msPerTick = 1000.0 / Stopwatch.Frequency;
+
+        public LatencyStats()
+        {
+            for (int i = 0; i < Stages.Length; i++) values[i] = new double[Window];
+        }
+
+        void Add(int stage, double ms)
+        {
+            values[stage][count[stage] % Window] = ms;
+            count[stage]++;
+        }
+
+        // Device and pipeline stages; call for every sample
+        public void AddSample(ref TelemetrySample s, ClockSync clock)
+        {
+            if (!s.HasStamps) return;
+            Add(TickToAdc, (int)(s.ConvUs - s.TickUs) / 1000.0);
+            Add(AdcToTx, (int)(s.TxUs - s.ConvUs) / 1000.0);
+            if (clock.Synced) Add(Wire, (s.RxTicks - clock.ToHostTicks(s.TxUs)) * msPerTick);
+            Add(Parse, (s.ParsedTicks - s.RxTicks) * msPerTick);
+        }
+
+        // UI stage; call for the sample that was actually put on screen
+        public void AddShown(ref TelemetrySample s, long shownTicks, ClockSync clock)
+        {
+            Add(Ui, (shownTicks - s.ParsedTicks) * msPerTick);
+            if (s.HasStamps && clock.Synced) Add(Total, (shownTicks - clock.ToHostTicks(s.ConvUs)) * msPerTick);
+        }
+
+        public int Count(int stage) { return count[stage]; }
+
+        // p50 / p99 / max over the window; false if the stage has no data yet
+        public bool Summary(int stage, out double p50, out double p99, out double max)
+        {
+            p50 = p99 = max = 0;
+            int n = Math.Min(count[stage], Window);
+            if (n == 0) return false;
+            double[] d = new double[n];
+            Array.Copy(values[stage], d, n);
+            Array.Sort(d);
+            p50 = d[(n - 1) / 2];
+            p99 = d[Math.Max(0, (int)Math.Ceiling(n * 0.99) - 1)];
+            max = d[n - 1];
+            return true;
+        }
+
+        public void Clear()
+        {
+            Array.Clear(count, 0, count.Length);
+        }
+    }
+}
@@ -0,0 +1,456 @@
+using System;
+using System.Diagnostics;
+using System.Drawing;
+using System.Globalization;
+using System.IO;
+using System.IO.Ports;
+using System.Threading;
+using System.Threading.Tasks;
+using System.Windows.Forms;
+
+namespace MicrocontrollerProject
+{
+    // Sanal cihazın ayarları. Satır biçimi cihazınkiyle aynı (HH:MM:SS;ADC;BTN).
+    public sealed class EmulatorSettings
+    {
+        public double LinesPerSecond = 1000; // 0 = as fast as the reader takes them
+        public int BaudLimit;                // 0 = no limit, else 8N1 bytes/s (baud / 10)
+        public bool Stamps;                  // Latency mode fields (;tick;conv;tx)
+        public double DropRate;              // Per byte: byte is lost
+        public double CorruptRate;           // Per byte: byte replaced by a random one
+        public int BurstEvery;               // Every N lines ...
+        public int BurstLines;               // ... this many extra lines arrive at once
+        public int TextEvery;                // Every N lines a 'D;...' frame (0 = none)
+        public int Seed = 1;                 // Same seed = same faults
+    }
+
+    // Endless device output as a read-only stream, for TelemetryPipeline or
+    // for a serial port (PumpTo). Lines are generated into the caller's
+    // buffer, so in steady state the emulator itself allocates nothing. A
+    // line that does not fit into what is left of a small buffer goes out
+    // partly, the rest comes first in the next read.
+    public sealed class DeviceEmulatorStream : Stream
+    {
+        const int MaxLineBytes = 128;
+        static readonly byte[] DiagText = System.Text.Encoding.ASCII.GetBytes(
+            "D;lps=41230;lmax=180;ovr=0;fe=0;cmd=12;rej=1;lcd=5012;adc=77;btn=2;boot=1840;rh=0,0,0,0,57,3,0,0\r\n");
+
+        readonly EmulatorSettings cfg;
+        readonly byte[] line = new byte[MaxLineBytes];
+        readonly byte[] carry = new byte[MaxLineBytes]; // Emitted line the caller had no room for
+        int carryPos, carryLen;
+        readonly double ticksPerSecond = Stopwatch.Frequency;
+        Stopwatch clock;
+        double dueSeconds;  // When the next line may leave
+        int burstLeft;
+        uint rng;
+
+        // Statistics
+        public long LinesSent, BytesSent, BytesDropped, BytesCorrupted;
+
+        public DeviceEmulatorStream(EmulatorSettings settings)
+        {
+            cfg = settings;
+            rng = (uint)settings.Seed | 1;
+        }
+
+        public override int Read(byte[] buffer, int offset, int count)
+        {
+            return ReadAsync(buffer, offset, count, CancellationToken.None).GetAwaiter().GetResult();
+        }
+
+        public override async Task<int> ReadAsync(byte[] buffer, int offset, int count, CancellationToken ct)
+        {
+            if (count == 0) return 0;
+            if (carryPos < carryLen) return TakeCarry(buffer, offset, count);
+            if (clock == null) clock = Stopwatch.StartNew();
+            while (true) {
+                double now = clock.ElapsedTicks / ticksPerSecond;
+                int pos = offset, end = offset + count;
+
+                while (pos < end && (cfg.LinesPerSecond <= 0 || dueSeconds <= now)) {
+                    int n = FormatLine();
+                    if (cfg.BaudLimit > 0 && BytesSent + n > now * cfg.BaudLimit / 10) break; // Wire is full
+                    Advance();
+                    if (end - pos >= MaxLineBytes) {
+                        pos = Emit(n, buffer, pos);
+                    } else {
+                        carryLen = Emit(n, carry, 0); // Last, partial line of this read
+                        carryPos = 0;
+                        pos += TakeCarry(buffer, pos, end - pos);
+                        break;
+                    }
+                }
+
+                if (pos > offset) return pos - offset;
+                await Task.Delay(1, ct).ConfigureAwait(false);
+            }
+        }
+
+        int TakeCarry(byte[] buffer, int offset, int count)
+        {
+            int n = Math.Min(count, carryLen - carryPos);
+            Buffer.BlockCopy(carry, carryPos, buffer, offset, n);
+            carryPos += n;
+            return n;
+        }
+
+        // Next due time; a burst sends its lines without waiting
+        void Advance()
+        {
+            LinesSent++;
+            if (cfg.BurstEvery > 0 && LinesSent % cfg.BurstEvery == 0) burstLeft = cfg.BurstLines;
+            if (burstLeft > 0) { burstLeft--; return; }
+            if (cfg.LinesPerSecond > 0) dueSeconds += 1.0 / cfg.LinesPerSecond;
+        }
+
+        // Line number LinesSent as the device would send it
+        int FormatLine()
+        {
+            long i = LinesSent;
+            if (cfg.TextEvery > 0 && i % cfg.TextEvery == cfg.TextEvery - 1) {
+                Buffer.BlockCopy(DiagText, 0, line, 0, DiagText.Length);
+                return DiagText.Length;
+            }
+
+            // Device time advances with the emulated rate, ADC is a triangle wave
+            long t = (cfg.LinesPerSecond > 0) ? (long)(i / cfg.LinesPerSecond) : i;
+            int adc = (int)(i % 8190);
+            if (adc > 4095) adc = 8190 - adc;
+
+            int p = 0;
+            p = TwoDigits((int)(t / 3600 % 24), p); line[p++] = (byte)':';
+            p = TwoDigits((int)(t / 60 % 60), p); line[p++] = (byte)':';
+            p = TwoDigits((int)(t % 60), p); line[p++] = (byte)';';
+            p = Number((uint)adc, p); line[p++] = (byte)';';
+            line[p++] = (byte)(i % 7 == 0 ? '1' : '0');
+            if (cfg.Stamps) {
+                uint us = (uint)(i * 1000);
+                line[p++] = (byte)';'; p = Number(us, p);
+                line[p++] = (byte)';'; p = Number(us + 12, p);
+                line[p++] = (byte)';'; p = Number(us + 15, p);
+            }
+            line[p++] = (byte)'\r';
+            line[p++] = (byte)'\n';
+            return p;
+        }
+
+        // Copies the line out, dropping / corrupting bytes as configured
+        int Emit(int n, byte[] b, int p)
+        {
+            BytesSent += n;
+            if (cfg.DropRate <= 0 && cfg.CorruptRate <= 0) {
+                Buffer.BlockCopy(line, 0, b, p, n);
+                return p + n;
+            }
+            for (int i = 0; i < n; i++) {
+                double r = Next();
+                if (r < cfg.DropRate) { BytesDropped++; continue; }
+                if (r < cfg.DropRate + cfg.CorruptRate) { b[p++] = (byte)(Next() * 256); BytesCorrupted++; continue; }
+                b[p++] = line[i];
+            }
+            return p;
+        }
+
+        // xorshift32, 0 <= x < 1
+        double Next()
+        {
+            rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+            return rng / 4294967296.0;
+        }
+
+        int TwoDigits(int v, int p)
+        {
+            line[p] = (byte)('0' + v / 10);
+            line[p + 1] = (byte)('0' + v % 10);
+            return p + 2;
+        }
+
+        int Number(uint v, int p)
+        {
+            int digits = 1;
+            for (uint t = v; t >= 10; t /= 10) digits++;
+            for (int i = digits - 1; i >= 0; i--) { line[p + i] = (byte)('0' + v % 10); v /= 10; }
+            return p + digits;
+        }
+
+        // Writes the output to another stream (e.g. one end of a virtual COM
+        // pair or a pseudo-terminal) until cancelled
+        public void PumpTo(Stream target, CancellationToken ct)
+        {
+            byte[] buf = new byte[TelemetryPipeline.ReadSize];
+            try {
+                while (!ct.IsCancellationRequested) {
+                    int n = ReadAsync(buf, 0, buf.Length, ct).GetAwaiter().GetResult();
+                    target.Write(buf, 0, n);
+                }
+            }
+            catch (OperationCanceledException) { }
+        }
+
+        public override bool CanRead { get { return true; } }
+        public override bool CanSeek { get { return false; } }
+        public override bool CanWrite { get { return false; } }
+        public override long Length { get { throw new NotSupportedException(); } }
+        public override long Position { get { return BytesSent; } set { throw new NotSupportedException(); } }
+        public override void Flush() { }
+        public override long Seek(long offset, SeekOrigin origin) { throw new NotSupportedException(); }
+        public override void SetLength(long value) { throw new NotSupportedException(); }
+        public override void Write(byte[] buffer, int offset, int count) { throw new NotSupportedException(); }
+    }
+
+    public sealed class BenchmarkResult
+    {
+        public double Seconds;
+        public long Lines, Samples, BadLines, TextLines, Dropped;
+        public long AllocatedBytes;
+        public int Gen0, Gen1, Gen2;
+        public TimeSpan GcPause;
+
+        public double SamplesPerSecond { get { return Samples / Seconds; } }
+        public double BytesPerSample { get { return Samples > 0 ? (double)AllocatedBytes / Samples : 0; } }
+
+        public override string ToString()
+        {
+            return string.Format(CultureInfo.InvariantCulture,
+                "{0:F0} samples/s ({1} in {2:F1} s, {3} lines sent)\r\n" +
+                "bad lines {4}, text lines {5}, dropped {6}\r\n" +
+                "allocated {7:F2} bytes/sample ({8} bytes)\r\n" +
+                "GC gen0/1/2 {9}/{10}/{11}, pause {12:F1} ms",
+                SamplesPerSecond, Samples, Seconds, Lines, BadLines, TextLines, Dropped,
+                BytesPerSample, AllocatedBytes, Gen0, Gen1, Gen2, GcPause.TotalMilliseconds);
+        }
+    }
+
+    // Runs the receive path (TelemetryPipeline) on emulator data without a
+    // window. A consumer drains the queues every UI frame like DrainTelemetry
+    // does, so the queue never grows and only the receive side is measured.
+    // Allocation and GC numbers are process wide, so keep other work idle.
+    public static class PipelineBenchmark
+    {
+        const int FrameMs = 16;
+
+        public static BenchmarkResult Run(EmulatorSettings settings, TimeSpan duration, TimeSpan warmup)
+        {
+            DeviceEmulatorStream emu = new DeviceEmulatorStream(settings);
+            TelemetryPipeline p = new TelemetryPipeline(emu);
+            p.Start();
+            try {
+                Drain(p, warmup);
+
+                long samples = p.SamplesParsed, bad = p.BadLines, dropped = p.DroppedSamples, lines = emu.LinesSent;
+                long text = 0;
+                long alloc = GC.GetTotalAllocatedBytes(true);
+                int g0 = GC.CollectionCount(0), g1 = GC.CollectionCount(1), g2 = GC.CollectionCount(2);
+                TimeSpan pause = GC.GetTotalPauseDuration();
+                Stopwatch sw = Stopwatch.StartNew();
+
+                text = Drain(p, duration);
+
+                BenchmarkResult r = new BenchmarkResult();
+                r.Seconds = sw.Elapsed.TotalSeconds;
+                r.AllocatedBytes = GC.GetTotalAllocatedBytes(true) - alloc;
+                r.Gen0 = GC.CollectionCount(0) - g0;
+                r.Gen1 = GC.CollectionCount(1) - g1;
+                r.Gen2 = GC.CollectionCount(2) - g2;
+                r.GcPause = GC.GetTotalPauseDuration() - pause;
+                r.Samples = p.SamplesParsed - samples;
+                r.BadLines = p.BadLines - bad;
+                r.Dropped = p.DroppedSamples - dropped;
+                r.Lines = emu.LinesSent - lines;
+                r.TextLines = text;
+                if (p.LastError != null) throw p.LastError;
+                return r;
+            }
+            finally {
+                p.Stop();
+            }
+        }
+
+        // Returns the number of text lines taken
+        static long Drain(TelemetryPipeline p, TimeSpan time)
+        {
+            Stopwatch sw = Stopwatch.StartNew();
+            TelemetrySample s;
+            string t;
+            long text = 0;
+            while (sw.Elapsed < time) {
+                Thread.Sleep(FrameMs);
+                while (p.TryTakeSample(out s)) { }
+                while (p.TextLines.TryDequeue(out t)) text++;
+            }
+            return text;
+        }
+    }
+
+    // Sanal cihaz penceresi: ana pencereyi besler, COM porta yazar veya benchmark çalıştırır
+    public class EmulatorForm : Form
+    {
+        readonly TextBox txtRate = new TextBox(), txtBaud = new TextBox(), txtDrop = new TextBox(),
+            txtCorrupt = new TextBox(), txtBurst = new TextBox(), txtText = new TextBox(), txtPort = new TextBox();
+        readonly CheckBox chkStamps = new CheckBox();
+        readonly TextBox txtResult = new TextBox();
+        readonly Button btnFeed = new Button(), btnPort = new Button(), btnBench = new Button();
+        readonly System.Windows.Forms.Timer statsTimer = new System.Windows.Forms.Timer();
+        readonly Func<EmulatorSettings, DeviceEmulatorStream> feedMain;
+        readonly Func<string> mainStatus;
+        DeviceEmulatorStream running;   // Feeding the main window or a port
+        CancellationTokenSource portCts;
+
+        // feedMain starts the main window's pipeline on an emulator (null = stop),
+        // mainStatus describes how that pipeline and the UI keep up
+        public EmulatorForm(Func<EmulatorSettings, DeviceEmulatorStream> feedMain, Func<string> mainStatus)
+        {
+            this.feedMain = feedMain;
+            this.mainStatus = mainStatus;
+            Text = "Device Emulator";
+            Size = new Size(480, 460);
+
+            TableLayoutPanel grid = new TableLayoutPanel();
+            grid.Dock = DockStyle.Top;
+            grid.AutoSize = true;
+            grid.ColumnCount = 2;
+            AddRow(grid, "Lines/s (0 = max)", txtRate, "1000");
+            AddRow(grid, "Baud limit (0 = none)", txtBaud, "0");
+            AddRow(grid, "Drop rate (per byte)", txtDrop, "0");
+            AddRow(grid, "Corrupt rate (per byte)", txtCorrupt, "0");
+            AddRow(grid, "Burst (every,lines)", txtBurst, "0,0");
+            AddRow(grid, "D frame every N lines", txtText, "0");
+            AddRow(grid, "COM port", txtPort, "COM10");
+            chkStamps.Text = "Latency stamps";
+            chkStamps.AutoSize = true;
+            grid.Controls.Add(new Label());
+            grid.Controls.Add(chkStamps);
+
+            FlowLayoutPanel buttons = new FlowLayoutPanel();
+            buttons.Dock = DockStyle.Top;
+            buttons.AutoSize = true;
+            SetupButton(btnFeed, "Feed main window", BtnFeedClick, buttons);
+            SetupButton(btnPort, "Write to COM port", BtnPortClick, buttons);
+            SetupButton(btnBench, "Benchmark (5 s)", BtnBenchClick, buttons);
+
+            txtResult.Multiline = true;
+            txtResult.ReadOnly = true;
+            txtResult.Dock = DockStyle.Fill;
+            txtResult.Font = new Font(FontFamily.GenericMonospace, 9);
+
+            Controls.Add(txtResult);
+            Controls.Add(buttons);
+            Controls.Add(grid);
+
+            statsTimer.Interval = 500;
+            statsTimer.Tick += delegate { ShowRunning(); };
+            FormClosing += delegate { StopAll(); };
+        }
+
+        static void AddRow(TableLayoutPanel grid, string label, TextBox box, string value)
+        {
+            Label l = new Label();
+            l.Text = label;
+            l.AutoSize = true;
+            l.Anchor = AnchorStyles.Left;
+            box.Width = 120;
+            box.Text = value;
+            grid.Controls.Add(l);
+            grid.Controls.Add(box);
+        }
+
+        static void SetupButton(Button b, string text, EventHandler click, Control parent)
+        {
+            b.Text = text;
+            b.AutoSize = true;
+            b.Click += click;
+            parent.Controls.Add(b);
+        }
+
+        EmulatorSettings ReadSettings()
+        {
+            EmulatorSettings s = new EmulatorSettings();
+            CultureInfo inv = CultureInfo.InvariantCulture;
+            string[] burst = txtBurst.Text.Split(',');
+            if (!double.TryParse(txtRate.Text, NumberStyles.Float, inv, out s.LinesPerSecond) || s.LinesPerSecond < 0
+                || !int.TryParse(txtBaud.Text, out s.BaudLimit) || s.BaudLimit < 0
+                || !double.TryParse(txtDrop.Text, NumberStyles.Float, inv, out s.DropRate)
+                || !double.TryParse(txtCorrupt.Text, NumberStyles.Float, inv, out s.CorruptRate)
+                || s.DropRate < 0 || s.CorruptRate < 0 || s.DropRate + s.CorruptRate > 1
+                || burst.Length != 2 || !int.TryParse(burst[0], out s.BurstEvery) || !int.TryParse(burst[1], out s.BurstLines)
+                || s.BurstEvery < 0 || s.BurstLines < 0
+                || !int.TryParse(txtText.Text, out s.TextEvery) || s.TextEvery < 0) {
+                MessageBox.Show("Check the emulator settings (rates are fractions, e.g. 0.001).");
+                return null;
+            }
+            s.Stamps = chkStamps.Checked;
+            return s;
+        }
+
+        void BtnFeedClick(object sender, EventArgs e)
+        {
+            if (running != null) { StopAll(); return; }
+            EmulatorSettings s = ReadSettings();
+            if (s == null) return;
+            running = feedMain(s);
+            if (running == null) return;
+            btnFeed.Text = "Stop";
+            statsTimer.Start();
+        }
+
+        void BtnPortClick(object sender, EventArgs e)
+        {
+            if (running != null) { StopAll(); return; }
+            EmulatorSettings s = ReadSettings();
+            if (s == null) return;
+
+            SerialPort port = new SerialPort(txtPort.Text.Trim(), s.BaudLimit > 0 ? s.BaudLimit : 115200);
+            try {
+                port.Open();
+            } catch (Exception ex) {
+                MessageBox.Show("Cannot open port: " + ex.Message);
+                return;
+            }
+            DeviceEmulatorStream emu = new DeviceEmulatorStream(s);
+            CancellationTokenSource cts = new CancellationTokenSource();
+            running = emu;
+            portCts = cts;
+            Task.Run(delegate {
+                try { emu.PumpTo(port.BaseStream, cts.Token); }
+                catch (IOException) { }
+                finally { port.Close(); }
+            });
+            btnPort.Text = "Stop";
+            statsTimer.Start();
+        }
+
+        void StopAll()
+        {
+            statsTimer.Stop();
+            if (portCts != null) { portCts.Cancel(); portCts = null; }
+            else if (running != null) feedMain(null);
+            running = null;
+            btnFeed.Text = "Feed main window";
+            btnPort.Text = "Write to COM port";
+        }
+
+        void ShowRunning()
+        {
+            DeviceEmulatorStream r = running;
+            if (r == null) return;
+            txtResult.Text = string.Format("lines {0}\r\nbytes {1}\r\ndropped bytes {2}\r\ncorrupted bytes {3}\r\n{4}",
+                r.LinesSent, r.BytesSent, r.BytesDropped, r.BytesCorrupted, portCts == null ? mainStatus() : "");
+        }
+
+        async void BtnBenchClick(object sender, EventArgs e)
+        {
+            EmulatorSettings s = ReadSettings();
+            if (s == null) return;
+            btnBench.Enabled = false;
+            txtResult.Text = "Running...";
+            try {
+                BenchmarkResult r = await Task.Run(() => PipelineBenchmark.Run(s, TimeSpan.FromSeconds(5), TimeSpan.FromSeconds(1)));
+                txtResult.Text = r.ToString();
+            } catch (Exception ex) {
+                txtResult.Text = "Benchmark failed: " + ex.Message;
+            }
+            btnBench.Enabled = true;
+        }
+    }
+}
@@ -0,0 +1,101 @@
+using System;
+using System.Collections.Generic;
+using System.Drawing;
+using System.Windows.Forms;
+
+namespace MicrocontrollerProject
+{
+    // 'D' komutunun cevabı: D;lps=41230;lmax=18250;...;rh=0,0,0,0,57,3,0,0
+    public static class DiagnosticsFrame
+    {
+        // Returns name -> value, or null if the line is not a diagnostics frame
+        public static Dictionary<string, string> Parse(string line)
+        {
+            line = line.Trim();
+            if (!line.StartsWith("D;")) return null;
+
+            var values = new Dictionary<string, string>();
+            foreach (string field in line.Substring(2).Split(';')) {
+                int eq = field.IndexOf('=');
+                if (eq > 0) values[field.Substring(0, eq)] = field.Substring(eq + 1);
+            }
+            return values;
+        }
+
+        // Human readable names for the keys in metrics.h
+        public static string Describe(string key)
+        {
+            switch (key) {
+                case "lps":  return "Main loop passes / s";
+                case "lmax": return "Longest loop pass (us)";
+                case "ovr":  return "UART RX overruns";
+                case "fe":   return "UART RX framing errors";
+                case "cmd":  return "Commands parsed";
+                case "rej":  return "Commands rejected";
+                case "lcd":  return "LCD bytes written";
+                case "lfr":  return "LCD frames shown";
+                case "ldr":  return "LCD frames dropped (late)";
+                case "lov":  return "LCD frame overflows";
+                case "adc":  return "ADC conversions";
+                case "btn":  return "Button presses";
+                case "boot": return "Reset -> first report (us)";
+                case "gup":  return "CGRAM glyph uploads";
+                case "ghit": return "CGRAM glyph cache hits";
+                case "gl":   return "Clock level (0=16, 1=40, 2=80 MHz)";
+                case "gu":   return "CPU busy, averaged (%)";
+                case "g16":  return "Time at 16 MHz (ms)";
+                case "g40":  return "Time at 40 MHz (ms)";
+                case "g80":  return "Time at 80 MHz (ms)";
+                case "gsw":  return "Clock switches";
+                case "gma":  return "Average current, estimate (mA x 10)";
+                case "led":  return "LED ADC samples (100/s)";
+                case "rh":   return "Report latency histogram (<1,2,4..64 ms, more)";
+                default:     return key;
+            }
+        }
+    }
+
+    // Teşhis paneli: açık olduğu sürece MainForm her saniye 'D' gönderir
+    public class DiagnosticsForm : Form
+    {
+        readonly ListView list = new ListView();
+        readonly Label lblUpdated = new Label();
+        readonly Dictionary<string, ListViewItem> rows = new Dictionary<string, ListViewItem>();
+
+        public DiagnosticsForm()
+        {
+            Text = "Diagnostics";
+            Size = new Size(460, 400);
+
+            list.View = View.Details;
+            list.FullRowSelect = true;
+            list.GridLines = true;
+            list.Dock = DockStyle.Fill;
+            list.Columns.Add("Metric", 260);
+            list.Columns.Add("Value", 170);
+
+            lblUpdated.Dock = DockStyle.Bottom;
+            lblUpdated.Text = "Waiting for device...";
+
+            Controls.Add(list);
+            Controls.Add(lblUpdated);
+        }
+
+        public void ShowFrame(Dictionary<string, string> values)
+        {
+            list.BeginUpdate();
+            foreach (var kv in values) {
+                ListViewItem row;
+                if (!rows.TryGetValue(kv.Key, out row)) {
+                    row = new ListViewItem(DiagnosticsFrame.Describe(kv.Key));
+                    row.SubItems.Add("");
+                    rows[kv.Key] = row;
+                    list.Items.Add(row);
+                }
+                row.SubItems[1].Text = kv.Value;
+            }
+            list.EndUpdate();
+            lblUpdated.Text = "Updated " + DateTime.Now.ToString("HH:mm:ss");
+        }
+    }
+}
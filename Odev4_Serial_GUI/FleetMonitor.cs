@@ -0,0 +1,328 @@
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Drawing;
+using System.IO;
+using System.IO.Ports;
+using System.Text;
+using System.Windows.Forms;
+
+namespace MicrocontrollerProject
+{
+    // One board: its own stream + TelemetryPipeline and the numbers the
+    // dashboard shows. Reading is async (ReadAsync on the pool), so dozens of
+    // sessions do not need dozens of dedicated threads.
+    public sealed class BoardSession : IDisposable
+    {
+        public readonly string Name;
+        readonly Stream stream;
+        readonly SerialPort port;   // null for plain streams (pseudo-terminals, tests)
+        readonly TelemetryPipeline pipeline;
+
+        // Latest values (updated by SessionManager.Drain)
+        public TelemetrySample Last;
+        public bool HasData;
+        public long Samples;        // Taken from the pipeline
+        public long TextLines;      // Non-report lines (ignored here)
+        public double Rate;         // Samples / s over the last second
+        public double LatencyMs;    // Worst receive -> drain delay in the last second
+        public double MaxGapMs;     // Longest silence between samples in the last second
+        public string Error;
+
+        long rateSamples;
+        double latencyWindow, gapWindow;
+        long lastRxTicks;
+
+        BoardSession(string name, Stream stream, SerialPort port)
+        {
+            Name = name;
+            this.stream = stream;
+            this.port = port;
+            pipeline = new TelemetryPipeline(stream);
+            pipeline.Start();
+        }
+
+        public static BoardSession OpenPort(string portName, int baud)
+        {
+            SerialPort p = new SerialPort(portName, baud, Parity.None, 8, StopBits.One);
+            p.Open();
+            return new BoardSession(portName, p.BaseStream, p);
+        }
+
+        // Any duplex stream, e.g. a FileStream on /dev/pts/N
+        public static BoardSession OpenStream(string name, Stream s)
+        {
+            return new BoardSession(name, s, null);
+        }
+
+        // Parse-side drops: queue overflow + lines that failed to parse / were too long
+        public long Drops
+        {
+            get { return pipeline.DroppedSamples + pipeline.BadLines + pipeline.OversizeLines; }
+        }
+
+        public bool Running { get { return pipeline.Running; } }
+
+        public void Send(string command)
+        {
+            try {
+                byte[] b = Encoding.ASCII.GetBytes(command);
+                stream.Write(b, 0, b.Length);
+            } catch (Exception ex) {
+                Error = ex.Message;
+            }
+        }
+
+        // Takes everything the pipeline has; called once per UI frame
+        internal void Drain(long now, double msPerTick)
+        {
+            TelemetrySample s;
+            while (pipeline.TryTakeSample(out s)) {
+                if (lastRxTicks != 0) gapWindow = Math.Max(gapWindow, (s.RxTicks - lastRxTicks) * msPerTick);
+                latencyWindow = Math.Max(latencyWindow, (now - s.RxTicks) * msPerTick);
+                lastRxTicks = s.RxTicks;
+                Last = s;
+                HasData = true;
+                Samples++;
+                rateSamples++;
+            }
+            string line;
+            while (pipeline.TextLines.TryDequeue(out line)) TextLines++;
+            if (pipeline.LastError != null) Error = pipeline.LastError.Message;
+        }
+
+        // Closes the one-second statistics window
+        internal void Second(double seconds)
+        {
+            Rate = rateSamples / seconds;
+            LatencyMs = latencyWindow;
+            MaxGapMs = gapWindow;
+            rateSamples = 0;
+            latencyWindow = gapWindow = 0;
+        }
+
+        public void Dispose()
+        {
+            pipeline.Stop();
+            try {
+                if (port != null) port.Close(); else stream.Dispose();
+            } catch (IOException) { }
+        }
+    }
+
+    // Owns all board sessions. Headless: the dashboard (or a test) calls
+    // Drain() at its own frame rate, which services every board in one pass.
+    public sealed class SessionManager : IDisposable
+    {
+        readonly List<BoardSession> sessions = new List<BoardSession>();
+        readonly Stopwatch window = Stopwatch.StartNew();
+        readonly double msPerTick = 1000.0 / Stopwatch.Frequency;
+
+        public IList<BoardSession> Sessions { get { return sessions.AsReadOnly(); } }
+
+        public BoardSession Add(BoardSession s)
+        {
+            sessions.Add(s);
+
+            // Streams without real async I/O (a tty opened as FileStream, some
+            // USB-serial drivers) park a pool thread inside every pending read.
+            // The pool only grows ~1 thread/s on its own, which would stall
+            // boards for many seconds after opening a large fleet.
+            int workers, io;
+            System.Threading.ThreadPool.GetMinThreads(out workers, out io);
+            if (workers < sessions.Count + 8) System.Threading.ThreadPool.SetMinThreads(sessions.Count + 8, io);
+            return s;
+        }
+
+        public void Remove(BoardSession s)
+        {
+            if (sessions.Remove(s)) s.Dispose();
+        }
+
+        // "COM3, COM5-COM8" -> COM3 COM5 COM6 COM7 COM8
+        public static List<string> ExpandPortList(string text)
+        {
+            var names = new List<string>();
+            foreach (string part in text.Split(new[] { ',', ' ', ';' }, StringSplitOptions.RemoveEmptyEntries)) {
+                string[] range = part.Split('-');
+                int a, b;
+                string prefix = TrimDigits(range[0]);
+                if (range.Length == 2 && int.TryParse(range[0].Substring(prefix.Length), out a)
+                    && int.TryParse(range[1].Substring(TrimDigits(range[1]).Length), out b)) {
+                    for (int i = a; i <= b; i++) names.Add(prefix + i);
+                } else {
+                    names.Add(part);
+                }
+            }
+            return names;
+        }
+
+        static string TrimDigits(string s)
+        {
+            return s.TrimEnd('0', '1', '2', '3', '4', '5', '6', '7', '8', '9');
+        }
+
+        // Same command to every board (time sync, LCD message, ...)
+        public void Broadcast(string command)
+        {
+            foreach (BoardSession s in sessions) s.Send(command);
+        }
+
+        // Returns true when the one-second statistics were refreshed
+        public bool Drain()
+        {
+            long now = Stopwatch.GetTimestamp();
+            foreach (BoardSession s in sessions) s.Drain(now, msPerTick);
+
+            double sec = window.Elapsed.TotalSeconds;
+            if (sec < 1) return false;
+            window.Restart();
+            foreach (BoardSession s in sessions) s.Second(sec);
+            return true;
+        }
+
+        public void Dispose()
+        {
+            foreach (BoardSession s in sessions) s.Dispose();
+            sessions.Clear();
+        }
+    }
+
+    // Çoklu kart paneli: her satır bir kart. Tek bir zamanlayıcı tüm kartları
+    // aynı karede günceller (satır başına Invoke yok).
+    public class FleetForm : Form
+    {
+        const int FrameMs = 50;
+
+        readonly SessionManager manager = new SessionManager();
+        readonly ListView list = new ListView();
+        readonly TextBox txtPorts = new TextBox();
+        readonly TextBox txtMessage = new TextBox();
+        readonly Label lblTotal = new Label();
+        readonly Timer frame = new Timer();
+        readonly Dictionary<BoardSession, ListViewItem> rows = new Dictionary<BoardSession, ListViewItem>();
+
+        public FleetForm()
+        {
+            Text = "Fleet Monitor";
+            Size = new Size(900, 500);
+
+            FlowLayoutPanel top = new FlowLayoutPanel();
+            top.Dock = DockStyle.Top;
+            top.AutoSize = true;
+
+            txtPorts.Width = 200;
+            txtPorts.Text = "COM3-COM6";
+            txtMessage.Width = 220;
+
+            top.Controls.Add(txtPorts);
+            top.Controls.Add(MakeButton("Open", BtnOpenClick));
+            top.Controls.Add(MakeButton("Close All", BtnCloseAllClick));
+            top.Controls.Add(MakeButton("Sync Time (all)", BtnSyncClick));
+            top.Controls.Add(txtMessage);
+            top.Controls.Add(MakeButton("Message (all)", BtnMessageClick));
+
+            list.View = View.Details;
+            list.FullRowSelect = true;
+            list.GridLines = true;
+            list.Dock = DockStyle.Fill;
+            foreach (string c in new[] { "Port", "Time", "ADC", "Button", "Rate/s", "Samples", "Drops", "Latency ms", "Max gap ms", "Status" })
+                list.Columns.Add(c, (c == "Status") ? 200 : 75);
+
+            lblTotal.Dock = DockStyle.Bottom;
+
+            Controls.Add(list);
+            Controls.Add(top);
+            Controls.Add(lblTotal);
+
+            frame.Interval = FrameMs;
+            frame.Tick += FrameTick;
+            frame.Start();
+        }
+
+        static Button MakeButton(string text, EventHandler click)
+        {
+            Button b = new Button();
+            b.Text = text;
+            b.AutoSize = true;
+            b.Click += click;
+            return b;
+        }
+
+        void BtnOpenClick(object sender, EventArgs e)
+        {
+            var failed = new List<string>();
+            foreach (string name in SessionManager.ExpandPortList(txtPorts.Text)) {
+                try {
+                    AddRow(manager.Add(BoardSession.OpenPort(name, 9600)));
+                } catch (Exception ex) {
+                    failed.Add(name + ": " + ex.Message);
+                }
+            }
+            if (failed.Count > 0) MessageBox.Show(string.Join("\r\n", failed.ToArray()));
+        }
+
+        void BtnCloseAllClick(object sender, EventArgs e)
+        {
+            manager.Dispose();
+            rows.Clear();
+            list.Items.Clear();
+        }
+
+        void BtnSyncClick(object sender, EventArgs e)
+        {
+            manager.Broadcast("S" + DateTime.Now.ToString("HH:mm:ss"));
+        }
+
+        void BtnMessageClick(object sender, EventArgs e)
+        {
+            string msg = txtMessage.Text.Replace("\r", " ").Replace("\n", " ");
+            manager.Broadcast("M" + msg + "\n");
+        }
+
+        void AddRow(BoardSession s)
+        {
+            ListViewItem row = new ListViewItem(s.Name);
+            for (int i = 1; i < list.Columns.Count; i++) row.SubItems.Add("");
+            rows[s] = row;
+            list.Items.Add(row);
+        }
+
+        void FrameTick(object sender, EventArgs e)
+        {
+            bool second = manager.Drain();
+
+            double rate = 0;
+            long drops = 0;
+            list.BeginUpdate();
+            foreach (var kv in rows) {
+                BoardSession s = kv.Key;
+                var c = kv.Value.SubItems;
+                if (s.HasData) {
+                    c[1].Text = s.Last.TimeText;
+                    c[2].Text = s.Last.Adc.ToString();
+                    c[3].Text = s.Last.Button ? "1" : "0";
+                }
+                c[5].Text = s.Samples.ToString();
+                c[6].Text = s.Drops.ToString();
+                if (second) {
+                    c[4].Text = s.Rate.ToString("F1");
+                    c[7].Text = s.LatencyMs.ToString("F1");
+                    c[8].Text = s.MaxGapMs.ToString("F0");
+                }
+                c[9].Text = s.Error ?? (s.Running ? "OK" : "closed");
+                rate += s.Rate;
+                drops += s.Drops;
+            }
+            list.EndUpdate();
+            lblTotal.Text = string.Format("{0} boards, {1:F1} samples/s total, {2} drops", rows.Count, rate, drops);
+        }
+
+        protected override void OnFormClosing(FormClosingEventArgs e)
+        {
+            frame.Stop();
+            manager.Dispose();
+            base.OnFormClosing(e);
+        }
+    }
+}
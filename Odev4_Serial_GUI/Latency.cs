@@ -0,0 +1,63 @@
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Drawing;
+using System.Globalization;
+using System.Windows.Forms;
+
+namespace MicrocontrollerProject
+{
+    // Gecikme paneli: açıkken cihaz 'L1' modunda, her saniye 'Q' ile saat eşitlenir
+    public class LatencyForm : Form
+    {
+        readonly ListView list = new ListView();
+        readonly Label lblSync = new Label();
+        readonly ListViewItem[] rows = new ListViewItem[LatencyStats.Stages.Length];
+
+        public LatencyForm()
+        {
+            Text = "Latency";
+            Size = new Size(560, 260);
+
+            list.View = View.Details;
+            list.FullRowSelect = true;
+            list.GridLines = true;
+            list.Dock = DockStyle.Fill;
+            list.Columns.Add("Stage", 200);
+            list.Columns.Add("n", 60);
+            list.Columns.Add("p50 ms", 80);
+            list.Columns.Add("p99 ms", 80);
+            list.Columns.Add("max ms", 80);
+            for (int i = 0; i < rows.Length; i++) {
+                rows[i] = new ListViewItem(LatencyStats.Stages[i]);
+                for (int c = 0; c < 4; c++) rows[i].SubItems.Add("");
+                list.Items.Add(rows[i]);
+            }
+
+            lblSync.Dock = DockStyle.Bottom;
+            lblSync.Text = "Clock: not synced";
+
+            Controls.Add(list);
+            Controls.Add(lblSync);
+        }
+
+        public void ShowStats(LatencyStats stats, ClockSync clock)
+        {
+            list.BeginUpdate();
+            for (int i = 0; i < rows.Length; i++) {
+                double p50, p99, max;
+                var c = rows[i].SubItems;
+                c[1].Text = stats.Count(i).ToString();
+                if (stats.Summary(i, out p50, out p99, out max)) {
+                    c[2].Text = p50.ToString("F2", CultureInfo.InvariantCulture);
+                    c[3].Text = p99.ToString("F2", CultureInfo.InvariantCulture);
+                    c[4].Text = max.ToString("F2", CultureInfo.InvariantCulture);
+                }
+            }
+            list.EndUpdate();
+            lblSync.Text = clock.Synced
+                ? string.Format(CultureInfo.InvariantCulture, "Clock synced, +/- {0:F2} ms", clock.ErrorUs / 1000)
+                : "Clock: not synced";
+        }
+    }
+}
@@ -0,0 +1,146 @@
+using System;
+using System.Drawing;
+using System.Globalization;
+using System.Windows.Forms;
+
+namespace MicrocontrollerProject
+{
+    // PC side of the 'W' command (led_pwm.h). A curve is 5 duty values
+    // (per mille) at ADC 0, 1024, 2048, 3072 and 4095.
+    public static class LedCurve
+    {
+        public const int Points = 5, MaxDuty = 1000, MaxAdc = 4095;
+        public static readonly char[] Colors = { 'R', 'G', 'B' };
+
+        // Same defaults as led_curve[] in led_pwm.h
+        public static readonly string[] Defaults = { "0,0,500,1000,1000", "1000,1000,500,0,0", "0,0,0,0,0" };
+
+        // "0, 250, 500, 750, 1000" -> points; false if malformed or out of range
+        public static bool TryParse(string text, out int[] points)
+        {
+            points = null;
+            string[] f = text.Split(',');
+            if (f.Length != Points) return false;
+            int[] p = new int[Points];
+            for (int i = 0; i < Points; i++) {
+                if (!int.TryParse(f[i].Trim(), NumberStyles.None, CultureInfo.InvariantCulture, out p[i])) return false;
+                if (p[i] > MaxDuty) return false;
+            }
+            points = p;
+            return true;
+        }
+
+        public static string Command(char color, int[] points)
+        {
+            return "W" + color + string.Join(",", Array.ConvertAll(points, v => v.ToString(CultureInfo.InvariantCulture))) + "\n";
+        }
+
+        public static string AlarmCommand(int level)
+        {
+            return "WA" + level.ToString(CultureInfo.InvariantCulture) + "\n";
+        }
+
+        // Same integer interpolation as Led_Curve() on the device
+        public static int Eval(int[] p, int adc)
+        {
+            int seg = adc >> 10, frac = adc & 1023;
+            if (seg >= Points - 1) return p[Points - 1];
+            return p[seg] + ((p[seg + 1] - p[seg]) * frac >> 10);
+        }
+    }
+
+    // LED eşleme penceresi: R/G/B eğrileri ve alarm seviyesi, altta ADC'ye göre renk önizlemesi
+    public class LedForm : Form
+    {
+        readonly TextBox[] txtCurve = new TextBox[3];
+        readonly TextBox txtAlarm = new TextBox();
+        readonly Panel preview = new Panel();
+        readonly Action<string> send;
+
+        public LedForm(Action<string> send)
+        {
+            this.send = send;
+            Text = "LED Mapping";
+            Size = new Size(460, 280);
+
+            TableLayoutPanel grid = new TableLayoutPanel();
+            grid.Dock = DockStyle.Top;
+            grid.AutoSize = true;
+            grid.ColumnCount = 2;
+
+            string[] names = { "Red", "Green", "Blue" };
+            for (int i = 0; i < 3; i++) {
+                txtCurve[i] = new TextBox();
+                txtCurve[i].Width = 300;
+                txtCurve[i].Text = LedCurve.Defaults[i];
+                txtCurve[i].TextChanged += delegate { preview.Invalidate(); };
+                grid.Controls.Add(MakeLabel(names[i] + " (per mille)"));
+                grid.Controls.Add(txtCurve[i]);
+            }
+            txtAlarm.Width = 80;
+            txtAlarm.Text = "0";
+            grid.Controls.Add(MakeLabel("Alarm ADC (0 = off)"));
+            grid.Controls.Add(txtAlarm);
+
+            Button btnSend = new Button();
+            btnSend.Text = "Send";
+            btnSend.AutoSize = true;
+            btnSend.Click += BtnSendClick;
+            grid.Controls.Add(new Label());
+            grid.Controls.Add(btnSend);
+
+            preview.Dock = DockStyle.Fill;
+            preview.Paint += PreviewPaint;
+
+            Controls.Add(preview);
+            Controls.Add(grid);
+        }
+
+        static Label MakeLabel(string text)
+        {
+            Label l = new Label();
+            l.Text = text;
+            l.AutoSize = true;
+            l.Anchor = AnchorStyles.Left;
+            return l;
+        }
+
+        void BtnSendClick(object sender, EventArgs e)
+        {
+            int[][] curves = new int[3][];
+            for (int i = 0; i < 3; i++) {
+                if (!LedCurve.TryParse(txtCurve[i].Text, out curves[i])) {
+                    MessageBox.Show("Each curve needs 5 values between 0 and 1000, separated by commas.");
+                    return;
+                }
+            }
+            int alarm;
+            if (!int.TryParse(txtAlarm.Text, out alarm) || alarm < 0 || alarm > LedCurve.MaxAdc) {
+                MessageBox.Show("Alarm level must be 0..4095.");
+                return;
+            }
+            for (int i = 0; i < 3; i++) send(LedCurve.Command(LedCurve.Colors[i], curves[i]));
+            send(LedCurve.AlarmCommand(alarm));
+        }
+
+        // Colour the LED shows across the ADC range (red band = alarm)
+        void PreviewPaint(object sender, PaintEventArgs e)
+        {
+            int[][] c = new int[3][];
+            for (int i = 0; i < 3; i++)
+                if (!LedCurve.TryParse(txtCurve[i].Text, out c[i])) return;
+            int alarm;
+            int.TryParse(txtAlarm.Text, out alarm);
+
+            int w = preview.ClientSize.Width, h = preview.ClientSize.Height;
+            for (int x = 0; x < w; x++) {
+                int adc = x * LedCurve.MaxAdc / Math.Max(1, w - 1);
+                Color col = (alarm > 0 && adc >= alarm) ? Color.Red : Color.FromArgb(
+                    LedCurve.Eval(c[0], adc) * 255 / LedCurve.MaxDuty,
+                    LedCurve.Eval(c[1], adc) * 255 / LedCurve.MaxDuty,
+                    LedCurve.Eval(c[2], adc) * 255 / LedCurve.MaxDuty);
+                using (Pen p = new Pen(col)) e.Graphics.DrawLine(p, x, 0, x, h);
+            }
+        }
+    }
+}
@@ -0,0 +1,174 @@
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Drawing;
+using System.Globalization;
+using System.IO.Ports;
+using System.Windows.Forms;
+
+namespace MicrocontrollerProject
+{
+    // Result of one step of the negotiation
+    public class LinkStep
+    {
+        public int Baud;
+        public bool Ok;
+        public double BytesPerSec; // Measured with the test pattern
+        public string Note;
+    }
+
+    // PC side of the 'B' / 'P' handshake in link.h. Runs synchronously on a
+    // port that nobody else is reading (the caller stops the pipeline first).
+    //
+    // The current rate is measured first. Then each proposed rate is tried,
+    // highest first. A good pattern is confirmed with "B!" (the device keeps
+    // the rate only then). On a timeout or a corrupt pattern the PC sends
+    // nothing more, goes back to the previous rate and waits for the device
+    // to do the same (it reverts by itself after LINK_VERIFY_MS), then tries
+    // the next lower rate.
+    public sealed class LinkNegotiator
+    {
+        public static readonly int[] Rates = { 921600, 460800, 230400, 115200, 57600, 38400, 19200 };
+        public const int PatternLines = 8, PatternLength = 64;
+        const int DeviceRevertMs = 2000 + 300; // LINK_VERIFY_MS + margin
+
+        readonly SerialPort port;
+        public Action<string> Log = delegate { };
+        public readonly List<LinkStep> Steps = new List<LinkStep>();
+
+        public LinkNegotiator(SerialPort port)
+        {
+            this.port = port;
+        }
+
+        // Returns the rate the link ended up at
+        public int Run(int maxBaud)
+        {
+            Steps.Add(Measure(port.BaudRate, "current rate"));
+
+            foreach (int rate in Rates) {
+                if (rate > maxBaud || rate <= port.BaudRate) continue;
+                LinkStep step = TryRate(rate);
+                Steps.Add(step);
+                if (step.Ok) break;
+            }
+            return port.BaudRate;
+        }
+
+        LinkStep TryRate(int rate)
+        {
+            int oldBaud = port.BaudRate;
+            Log(string.Format("Trying {0} baud...", rate));
+
+            port.DiscardInBuffer();
+            port.Write("B" + rate + "\n");
+            string reply = WaitForLine("B;", 1500);
+            if (reply == null) return Failed(rate, "no answer to B");
+            string[] f = reply.Split(';');
+            if (f.Length < 4 || f[1] != "OK") return Failed(rate, "device refused (" + reply + ")");
+            bool flow = f[3] == "1";
+
+            // The device switches as soon as its reply has left the UART
+            port.BaudRate = rate;
+            port.Handshake = flow ? Handshake.RequestToSend : Handshake.None;
+            port.DiscardInBuffer();
+
+            LinkStep step = Measure(rate, flow ? "RTS/CTS" : "no flow control");
+            if (step.Ok) {
+                port.Write("B!\n");
+                if (WaitForLine("B;KEEP;", 1000) != null) return step;
+                step.Ok = false;
+                step.Note += ", no answer to B!";
+                Log("  not confirmed, going back");
+            }
+
+            // Go back and let the device time out to the same rate
+            port.BaudRate = oldBaud;
+            port.Handshake = Handshake.None;
+            System.Threading.Thread.Sleep(DeviceRevertMs);
+            port.DiscardInBuffer();
+            return step;
+        }
+
+        // Asks for the test pattern and checks every line of it
+        LinkStep Measure(int rate, string note)
+        {
+            LinkStep step = new LinkStep { Baud = rate, Note = note };
+            // 8 lines of ~70 bytes, 10 bits per byte, plus generous slack
+            int timeoutMs = 500 + PatternLines * 80 * 10 * 1000 / rate;
+
+            Stopwatch sw = Stopwatch.StartNew();
+            port.Write("P" + PatternLines);
+            int bytes = 0, good = 0;
+            for (int n = 0; n < PatternLines; n++) {
+                string line = WaitForLine("P;", timeoutMs - (int)sw.ElapsedMilliseconds);
+                if (line == null) break;
+                bytes += line.Length + 1;
+                if (PatternOk(line, n)) good++;
+            }
+            double sec = sw.Elapsed.TotalSeconds;
+
+            step.Ok = good == PatternLines;
+            step.BytesPerSec = step.Ok ? bytes / sec : 0;
+            if (!step.Ok) step.Note += string.Format(", {0}/{1} pattern lines ok", good, PatternLines);
+            Log(string.Format(CultureInfo.InvariantCulture, "  {0,7} baud: {1} ({2}), {3:F0} B/s",
+                rate, step.Ok ? "OK" : "FAILED", step.Note, step.BytesPerSec));
+            return step;
+        }
+
+        // Same generator as Link_Command_Pattern in link.h
+        static bool PatternOk(string line, int n)
+        {
+            string head = "P;" + n + ";";
+            if (!line.StartsWith(head) || line.Length != head.Length + PatternLength) return false;
+            for (int i = 0; i < PatternLength; i++)
+                if (line[head.Length + i] != (char)('!' + (i * 7 + n) % 94)) return false;
+            return true;
+        }
+
+        // Next line starting with 'prefix' (reports in between are skipped)
+        string WaitForLine(string prefix, int timeoutMs)
+        {
+            Stopwatch sw = Stopwatch.StartNew();
+            while (sw.ElapsedMilliseconds < timeoutMs) {
+                port.ReadTimeout = Math.Max(1, timeoutMs - (int)sw.ElapsedMilliseconds);
+                try {
+                    string line = port.ReadLine().TrimEnd('\r');
+                    if (line.StartsWith(prefix)) return line;
+                } catch (TimeoutException) {
+                    return null;
+                }
+            }
+            return null;
+        }
+
+        LinkStep Failed(int rate, string why)
+        {
+            Log(string.Format("  {0,7} baud: FAILED ({1})", rate, why));
+            return new LinkStep { Baud = rate, Note = why };
+        }
+    }
+
+    // Bağlantı hızı penceresi: pazarlığın her adımını ve ölçülen hızı gösterir
+    public class LinkForm : Form
+    {
+        readonly TextBox txtLog = new TextBox();
+
+        public LinkForm()
+        {
+            Text = "Link Speed";
+            Size = new Size(520, 300);
+            txtLog.Multiline = true;
+            txtLog.ReadOnly = true;
+            txtLog.ScrollBars = ScrollBars.Vertical;
+            txtLog.Font = new Font(FontFamily.GenericMonospace, 9);
+            txtLog.Dock = DockStyle.Fill;
+            Controls.Add(txtLog);
+        }
+
+        public void Append(string line)
+        {
+            txtLog.AppendText(line + "\r\n");
+        }
+    }
+}
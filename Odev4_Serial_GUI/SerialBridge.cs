@@ -0,0 +1,366 @@
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Net;
+using System.Net.Sockets;
+using System.Security.Cryptography;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace MicrocontrollerProject
+{
+    // One connected consumer. Outgoing messages go through a bounded queue:
+    // when a slow client falls behind, the OLDEST messages are dropped so it
+    // always sees current data and can never stall the device side.
+    public sealed class BridgeClient
+    {
+        public readonly int Id;
+        public readonly EndPoint Remote;
+        public readonly bool WebSocket;
+        public long Sent, Dropped, Commands;
+
+        readonly TcpClient tcp;
+        readonly Stream stream;
+        readonly ConcurrentQueue<string> outbox = new ConcurrentQueue<string>();
+        readonly SemaphoreSlim pending = new SemaphoreSlim(0);
+        readonly int maxQueued;
+        int queued;
+
+        internal BridgeClient(int id, TcpClient tcp, Stream stream, bool webSocket, int maxQueued)
+        {
+            Id = id;
+            this.tcp = tcp;
+            this.stream = stream;
+            Remote = tcp.Client.RemoteEndPoint;
+            WebSocket = webSocket;
+            this.maxQueued = maxQueued;
+        }
+
+        internal void Enqueue(string message)
+        {
+            outbox.Enqueue(message);
+            if (Interlocked.Increment(ref queued) > maxQueued) {
+                string old;
+                if (outbox.TryDequeue(out old)) {
+                    Interlocked.Decrement(ref queued);
+                    Interlocked.Increment(ref Dropped);
+                }
+            }
+            if (pending.CurrentCount == 0) pending.Release();
+        }
+
+        // Writes whatever is queued in one batch per wake-up
+        internal async Task SendLoop(CancellationToken ct)
+        {
+            var batch = new MemoryStream();
+            while (!ct.IsCancellationRequested) {
+                await pending.WaitAsync(ct).ConfigureAwait(false);
+                batch.SetLength(0);
+                string msg;
+                while (outbox.TryDequeue(out msg)) {
+                    Interlocked.Decrement(ref queued);
+                    byte[] payload = Encoding.UTF8.GetBytes(msg + "\n");
+                    if (WebSocket) WsFrame.WriteText(batch, payload);
+                    else batch.Write(payload, 0, payload.Length);
+                    Sent++;
+                }
+                if (batch.Length > 0)
+                    await stream.WriteAsync(batch.GetBuffer(), 0, (int)batch.Length, ct).ConfigureAwait(false);
+            }
+        }
+
+        // Lines (or WebSocket text frames) from the client are device commands
+        internal async Task ReceiveLoop(Action<BridgeClient, string> onCommand, CancellationToken ct)
+        {
+            if (WebSocket) {
+                while (true) {
+                    string text = await WsFrame.ReadText(stream, ct).ConfigureAwait(false);
+                    if (text == null) return;
+                    foreach (string line in text.Split('\n')) onCommand(this, line);
+                }
+            }
+            using (var reader = new StreamReader(stream, Encoding.ASCII, false, 256, true)) {
+                string line;
+                while ((line = await reader.ReadLineAsync().ConfigureAwait(false)) != null) onCommand(this, line);
+            }
+        }
+
+        internal void Close()
+        {
+            tcp.Close();
+        }
+    }
+
+    // Headless serial-to-TCP bridge. Owns the device stream, decodes it with
+    // the same TelemetryPipeline the GUI uses and fans every message out to
+    // all clients as one JSON object per line:
+    //     {"type":"report","time":"12:00:05","adc":2048,"btn":1,"rx":1718000000123}
+    //     {"type":"line","text":"D;lps=41230;..."}
+    // Plain TCP clients read/write lines; a client that opens with an HTTP
+    // "Upgrade: websocket" request gets the same stream as WebSocket frames.
+    // Client lines are device commands ("S12:00:00", "MHello", "D") and are
+    // written to the port whole, one at a time, so commands from different
+    // clients never interleave.
+    public sealed class SerialBridge : IDisposable
+    {
+        public int MaxQueuedPerClient = 2048;
+        public const int PollMs = 5;
+
+        readonly Stream device;
+        readonly TelemetryPipeline pipeline;
+        readonly TcpListener listener;
+        readonly ConcurrentDictionary<int, BridgeClient> clients = new ConcurrentDictionary<int, BridgeClient>();
+        readonly BlockingCollection<string> commands = new BlockingCollection<string>(256);
+        readonly CancellationTokenSource cts = new CancellationTokenSource();
+        int nextId;
+
+        public long Messages, CommandsForwarded, CommandsDropped;
+        public Action<string> Log = delegate { };
+
+        public SerialBridge(Stream device, IPEndPoint listen)
+        {
+            this.device = device;
+            pipeline = new TelemetryPipeline(device);
+            listener = new TcpListener(listen);
+        }
+
+        public ICollection<BridgeClient> Clients { get { return clients.Values; } }
+        public TelemetryPipeline Pipeline { get { return pipeline; } }
+        public EndPoint LocalEndpoint { get { return listener.LocalEndpoint; } }
+
+        public void Start()
+        {
+            pipeline.Start();
+            listener.Start();
+            Task.Run(() => AcceptLoop(cts.Token));
+            Task.Run(() => FanOutLoop(cts.Token));
+            new Thread(CommandLoop) { IsBackground = true, Name = "bridge-tx" }.Start();
+        }
+
+        async Task AcceptLoop(CancellationToken ct)
+        {
+            while (!ct.IsCancellationRequested) {
+                TcpClient tcp;
+                try { tcp = await listener.AcceptTcpClientAsync().ConfigureAwait(false); }
+                catch (ObjectDisposedException) { return; }
+                catch (SocketException) { return; }
+                tcp.NoDelay = true;
+                var task = ServeClient(tcp, ct);
+            }
+        }
+
+        async Task ServeClient(TcpClient tcp, CancellationToken ct)
+        {
+            BridgeClient c = null;
+            CancellationTokenSource life = null; // Ends this client's loops only
+            Task sender = null;
+            try {
+                NetworkStream ns = tcp.GetStream();
+                // WebSocket clients start with "GET "; raw clients either start
+                // with a command or send nothing, so do not wait for a first byte
+                bool ws = await WsFrame.TryHandshake(ns, ct).ConfigureAwait(false);
+                c = new BridgeClient(Interlocked.Increment(ref nextId), tcp, ns, ws, MaxQueuedPerClient);
+                clients[c.Id] = c;
+                Log(string.Format("client {0} connected from {1}{2}", c.Id, c.Remote, ws ? " (websocket)" : ""));
+
+                life = CancellationTokenSource.CreateLinkedTokenSource(ct);
+                sender = c.SendLoop(life.Token);
+                await c.ReceiveLoop(OnCommand, life.Token).ConfigureAwait(false);
+            }
+            catch (IOException) { }
+            catch (ObjectDisposedException) { }
+            catch (OperationCanceledException) { }
+            finally {
+                if (life != null) life.Cancel();
+                tcp.Close(); // Also ends a write the sender is blocked in
+                if (sender != null) {
+                    try { await sender.ConfigureAwait(false); }
+                    catch (IOException) { }
+                    catch (ObjectDisposedException) { }
+                    catch (OperationCanceledException) { }
+                }
+                if (life != null) life.Dispose();
+                if (c != null) {
+                    BridgeClient removed;
+                    clients.TryRemove(c.Id, out removed);
+                    Log(string.Format("client {0} gone (sent {1}, dropped {2})", c.Id, c.Sent, c.Dropped));
+                }
+            }
+        }
+
+        void OnCommand(BridgeClient from, string line)
+        {
+            line = line.TrimEnd('\r');
+            if (line.Length == 0) return;
+            Interlocked.Increment(ref from.Commands);
+            // The device ignores line endings between commands, and 'M' needs one
+            if (commands.TryAdd(line + "\n")) return;
+            // Device side stalled (256 commands waiting): tell the sender
+            Interlocked.Increment(ref CommandsDropped);
+            from.Enqueue(TextJson(new StringBuilder(64), "error", "command queue full, dropped: " + line));
+        }
+
+        // Single writer to the device
+        void CommandLoop()
+        {
+            try {
+                foreach (string cmd in commands.GetConsumingEnumerable(cts.Token)) {
+                    byte[] b = Encoding.ASCII.GetBytes(cmd);
+                    device.Write(b, 0, b.Length);
+                    Interlocked.Increment(ref CommandsForwarded);
+                }
+            }
+            catch (OperationCanceledException) { }
+            catch (Exception ex) { Log("device write failed: " + ex.Message); }
+        }
+
+        // Drains the pipeline and hands every message to every client queue
+        async Task FanOutLoop(CancellationToken ct)
+        {
+            var sb = new StringBuilder(128);
+            while (!ct.IsCancellationRequested) {
+                TelemetrySample s;
+                while (pipeline.TryTakeSample(out s)) Publish(ReportJson(sb, s));
+                string line;
+                while (pipeline.TextLines.TryDequeue(out line)) Publish(TextJson(sb, "line", line));
+                try { await Task.Delay(PollMs, ct).ConfigureAwait(false); }
+                catch (OperationCanceledException) { return; }
+            }
+        }
+
+        void Publish(string json)
+        {
+            Messages++;
+            foreach (BridgeClient c in clients.Values) c.Enqueue(json);
+        }
+
+        static readonly DateTime Epoch = new DateTime(1970, 1, 1, 0, 0, 0, DateTimeKind.Utc);
+
+        static string ReportJson(StringBuilder sb, TelemetrySample s)
+        {
+            sb.Length = 0;
+            sb.Append("{\"type\":\"report\",\"time\":\"").Append(s.TimeText)
+              .Append("\",\"adc\":").Append(s.Adc.ToString(CultureInfo.InvariantCulture))
+              .Append(",\"btn\":").Append(s.Button ? '1' : '0')
+              .Append(",\"rx\":").Append(((long)(DateTime.UtcNow - Epoch).TotalMilliseconds).ToString(CultureInfo.InvariantCulture))
+              .Append('}');
+            return sb.ToString();
+        }
+
+        // {"type":"<type>","text":"<text>"}, 'type' needs no escaping
+        static string TextJson(StringBuilder sb, string type, string text)
+        {
+            sb.Length = 0;
+            sb.Append("{\"type\":\"").Append(type).Append("\",\"text\":\"");
+            foreach (char ch in text) {
+                if (ch == '"' || ch == '\\') sb.Append('\\').Append(ch);
+                else if (ch < ' ') sb.AppendFormat("\\u{0:X4}", (int)ch);
+                else sb.Append(ch);
+            }
+            return sb.Append("\"}").ToString();
+        }
+
+        public void Dispose()
+        {
+            cts.Cancel();
+            listener.Stop();
+            pipeline.Stop();
+            foreach (BridgeClient c in clients.Values) c.Close();
+        }
+    }
+
+    // Minimal RFC 6455 server side: handshake, unfragmented text frames out,
+    // masked text frames in. Enough for browsers and websocket libraries.
+    static class WsFrame
+    {
+        const string Guid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+        // Peeks at the first bytes; performs the upgrade if this is an HTTP request
+        public static async Task<bool> TryHandshake(NetworkStream ns, CancellationToken ct)
+        {
+            // Give an HTTP client a moment to send its request line
+            for (int i = 0; i < 20 && !ns.DataAvailable; i++) await Task.Delay(10, ct).ConfigureAwait(false);
+            if (!ns.DataAvailable) return false;
+
+            byte[] peek = new byte[4];
+            if (ns.Socket.Receive(peek, 0, 4, SocketFlags.Peek) < 4 || Encoding.ASCII.GetString(peek) != "GET ") return false;
+
+            // Read the request header byte by byte up to the blank line
+            var header = new StringBuilder();
+            byte[] one = new byte[1];
+            while (!header.ToString().EndsWith("\r\n\r\n")) {
+                if (await ns.ReadAsync(one, 0, 1, ct).ConfigureAwait(false) != 1 || header.Length > 8192)
+                    throw new IOException("bad websocket request");
+                header.Append((char)one[0]);
+            }
+
+            string key = null;
+            foreach (string h in header.ToString().Split(new[] { "\r\n" }, StringSplitOptions.None)) {
+                if (h.StartsWith("Sec-WebSocket-Key:", StringComparison.OrdinalIgnoreCase))
+                    key = h.Substring(18).Trim();
+            }
+            if (key == null) throw new IOException("not a websocket request");
+
+            string accept;
+            using (SHA1 sha = SHA1.Create())
+                accept = Convert.ToBase64String(sha.ComputeHash(Encoding.ASCII.GetBytes(key + Guid)));
+            byte[] reply = Encoding.ASCII.GetBytes("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n" +
+                "Connection: Upgrade\r\nSec-WebSocket-Accept: " + accept + "\r\n\r\n");
+            await ns.WriteAsync(reply, 0, reply.Length, ct).ConfigureAwait(false);
+            return true;
+        }
+
+        public static void WriteText(Stream s, byte[] payload)
+        {
+            s.WriteByte(0x81); // FIN + text
+            if (payload.Length < 126) {
+                s.WriteByte((byte)payload.Length);
+            } else {
+                s.WriteByte(126);
+                s.WriteByte((byte)(payload.Length >> 8));
+                s.WriteByte((byte)payload.Length);
+            }
+            s.Write(payload, 0, payload.Length);
+        }
+
+        // Next text message, or null when the client closes
+        public static async Task<string> ReadText(Stream s, CancellationToken ct)
+        {
+            byte[] h = new byte[14];
+            while (true) {
+                if (!await ReadExactly(s, h, 0, 2, ct).ConfigureAwait(false)) return null;
+                int op = h[0] & 0x0F;
+                bool masked = (h[1] & 0x80) != 0;
+                long len = h[1] & 0x7F;
+                if (len == 126) {
+                    if (!await ReadExactly(s, h, 2, 2, ct).ConfigureAwait(false)) return null;
+                    len = (h[2] << 8) | h[3];
+                } else if (len == 127) {
+                    return null; // Commands are tiny; refuse huge frames
+                }
+                byte[] mask = new byte[4];
+                if (masked && !await ReadExactly(s, mask, 0, 4, ct).ConfigureAwait(false)) return null;
+                byte[] payload = new byte[len];
+                if (!await ReadExactly(s, payload, 0, (int)len, ct).ConfigureAwait(false)) return null;
+                if (masked) for (int i = 0; i < payload.Length; i++) payload[i] ^= mask[i & 3];
+
+                if (op == 0x8) return null;                 // Close
+                if (op == 0x1) return Encoding.UTF8.GetString(payload);
+                // Ping/pong/binary are ignored
+            }
+        }
+
+        static async Task<bool> ReadExactly(Stream s, byte[] b, int off, int n, CancellationToken ct)
+        {
+            while (n > 0) {
+                int r = await s.ReadAsync(b, off, n, ct).ConfigureAwait(false);
+                if (r <= 0) return false;
+                off += r; n -= r;
+            }
+            return true;
+        }
+    }
+}
@@ -0,0 +1,394 @@
+using System;
+using System.Diagnostics;
+using System.IO;
+using System.IO.MemoryMappedFiles;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace MicrocontrollerProject
+{
+    // Kayıt dosyası (.tlog) düzeni. Tüm sayılar little-endian.
+    //
+    //   File header (64 B) : "TLOG", version, samples per block, start time (UTC ticks)
+    //   Block 0..n         : fixed size, so block i starts at Header + i * BlockBytes
+    //       block header (32 B) : "BLK0", count, first time, last time
+    //       TimeUs   long[B]    : microseconds since the file was created
+    //       Clock    int[B]     : device clock, h * 3600 + m * 60 + s
+    //       Adc      ushort[B]
+    //       Button   byte[B]
+    //
+    // Each column is contiguous inside its block, so scanning one column (e.g.
+    // ADC for a chart) touches only that column's pages. The block index is a
+    // sidecar "<file>.idx" with {first time, last time} per block, appended
+    // whenever a block is written; the reader rebuilds it from the block
+    // headers if it is missing or shorter than the log.
+    public static class TelemetryLogFormat
+    {
+        public const uint FileMagic = 0x474F4C54;  // "TLOG"
+        public const uint BlockMagic = 0x304B4C42; // "BLK0"
+        public const int Version = 1;
+        public const int HeaderBytes = 64;
+        public const int BlockHeaderBytes = 32;
+        public const int BlockSamples = 4096;
+        public const int IndexEntryBytes = 16;
+
+        public const int TimeOffset = BlockHeaderBytes;
+        public const int ClockOffset = TimeOffset + 8 * BlockSamples;
+        public const int AdcOffset = ClockOffset + 4 * BlockSamples;
+        public const int ButtonOffset = AdcOffset + 2 * BlockSamples;
+        public const int BlockBytes = ButtonOffset + BlockSamples;
+
+        public static string IndexPath(string path) { return path + ".idx"; }
+    }
+
+    // Append-only writer. Samples are collected into one in-memory block and
+    // written as a whole when it fills (and on Dispose), so the disk sees one
+    // ~60 KB sequential write per 4096 samples. A crash loses at most the
+    // block being collected.
+    public sealed class TelemetryLogWriter : IDisposable
+    {
+        readonly FileStream data, index;
+        readonly BinaryWriter dataOut, indexOut;
+        readonly long startTicks = Stopwatch.GetTimestamp();
+        readonly double usPerTick = 1e6 / Stopwatch.Frequency;
+        readonly object sync = new object();
+
+        readonly long[] time = new long[TelemetryLogFormat.BlockSamples];
+        readonly int[] clock = new int[TelemetryLogFormat.BlockSamples];
+        readonly ushort[] adc = new ushort[TelemetryLogFormat.BlockSamples];
+        readonly byte[] button = new byte[TelemetryLogFormat.BlockSamples];
+        int count;
+        bool closed;
+
+        public readonly string Path;
+        public long SamplesWritten, BlocksWritten;
+
+        public TelemetryLogWriter(string path)
+        {
+            Path = path;
+            data = new FileStream(path, FileMode.CreateNew, FileAccess.Write, FileShare.Read);
+            index = new FileStream(TelemetryLogFormat.IndexPath(path), FileMode.Create, FileAccess.Write, FileShare.Read);
+            dataOut = new BinaryWriter(data);
+            indexOut = new BinaryWriter(index);
+
+            dataOut.Write(TelemetryLogFormat.FileMagic);
+            dataOut.Write(TelemetryLogFormat.Version);
+            dataOut.Write(TelemetryLogFormat.BlockSamples);
+            dataOut.Write(DateTime.UtcNow.Ticks);
+            dataOut.Write(new byte[TelemetryLogFormat.HeaderBytes - 20]);
+            dataOut.Flush();
+        }
+
+        // Creates "<dir>/yyyyMMdd_HHmmss.tlog"
+        public static TelemetryLogWriter CreateIn(string dir)
+        {
+            Directory.CreateDirectory(dir);
+            return new TelemetryLogWriter(System.IO.Path.Combine(dir, DateTime.Now.ToString("yyyyMMdd_HHmmss") + ".tlog"));
+        }
+
+        // Safe to call from the pipeline's parser thread
+        public void Append(ref TelemetrySample s)
+        {
+            lock (sync) {
+                if (closed) return;
+                time[count] = (long)((s.RxTicks - startTicks) * usPerTick);
+                clock[count] = s.Hour * 3600 + s.Minute * 60 + s.Second;
+                adc[count] = (ushort)Math.Max(0, Math.Min(ushort.MaxValue, s.Adc));
+                button[count] = (byte)(s.Button ? 1 : 0);
+                SamplesWritten++;
+                if (++count == TelemetryLogFormat.BlockSamples) WriteBlock();
+            }
+        }
+
+        void WriteBlock()
+        {
+            int n = TelemetryLogFormat.BlockSamples;
+            dataOut.Write(TelemetryLogFormat.BlockMagic);
+            dataOut.Write(count);
+            dataOut.Write(time[0]);
+            dataOut.Write(time[count - 1]);
+            dataOut.Write(0L);
+            for (int i = 0; i < n; i++) dataOut.Write(i < count ? time[i] : time[count - 1]);
+            for (int i = 0; i < n; i++) dataOut.Write(clock[i]);
+            for (int i = 0; i < n; i++) dataOut.Write(adc[i]);
+            dataOut.Write(button, 0, n);
+            dataOut.Flush();
+
+            indexOut.Write(time[0]);
+            indexOut.Write(time[count - 1]);
+            indexOut.Flush();
+
+            BlocksWritten++;
+            count = 0;
+        }
+
+        public void Dispose()
+        {
+            lock (sync) {
+                if (closed) return;
+                closed = true;
+                if (count > 0) WriteBlock(); // Last block is padded to full size
+                dataOut.Dispose();
+                indexOut.Dispose();
+            }
+        }
+    }
+
+    // Random access reader over a memory-mapped log. Opening maps the file and
+    // loads (or rebuilds) the block index; nothing else is read until asked.
+    // A log that is still being recorded can be opened: only the blocks that
+    // were complete at open time are visible.
+    public sealed class TelemetryLogReader : IDisposable
+    {
+        readonly MemoryMappedFile map;
+        readonly MemoryMappedViewAccessor view;
+        readonly long[] blockFirst, blockLast; // Block index (TimeUs)
+        readonly int[] blockCount;
+        readonly long[] blockStart;            // Global index of each block's first sample
+
+        public readonly DateTime StartUtc;
+        public readonly long Count;
+
+        public TelemetryLogReader(string path)
+        {
+            // The mapping takes ownership of the file handle
+            FileStream fs = new FileStream(path, FileMode.Open, FileAccess.Read, FileShare.ReadWrite);
+            if (fs.Length < TelemetryLogFormat.HeaderBytes) {
+                fs.Dispose();
+                throw new InvalidDataException("Not a telemetry log: " + path);
+            }
+            long blocks = (fs.Length - TelemetryLogFormat.HeaderBytes) / TelemetryLogFormat.BlockBytes;
+            map = MemoryMappedFile.CreateFromFile(fs, null, 0, MemoryMappedFileAccess.Read, HandleInheritability.None, false);
+            view = map.CreateViewAccessor(0, 0, MemoryMappedFileAccess.Read);
+
+            if (view.ReadUInt32(0) != TelemetryLogFormat.FileMagic || view.ReadInt32(4) != TelemetryLogFormat.Version
+                || view.ReadInt32(8) != TelemetryLogFormat.BlockSamples) {
+                Dispose();
+                throw new InvalidDataException("Unsupported telemetry log: " + path);
+            }
+            StartUtc = new DateTime(view.ReadInt64(12), DateTimeKind.Utc);
+
+            blockFirst = new long[blocks];
+            blockLast = new long[blocks];
+            blockCount = new int[blocks];
+            blockStart = new long[blocks];
+
+            LoadIndex(TelemetryLogFormat.IndexPath(path));
+
+            long total = 0;
+            for (int b = 0; b < blockCount.Length; b++) {
+                blockCount[b] = view.ReadInt32(BlockOffset(b) + 4);
+                blockStart[b] = total;
+                total += blockCount[b];
+            }
+            Count = total;
+        }
+
+        void LoadIndex(string indexPath)
+        {
+            int fromIndex = 0;
+            if (File.Exists(indexPath)) {
+                byte[] idx = File.ReadAllBytes(indexPath);
+                fromIndex = Math.Min(blockFirst.Length, idx.Length / TelemetryLogFormat.IndexEntryBytes);
+                for (int b = 0; b < fromIndex; b++) {
+                    blockFirst[b] = BitConverter.ToInt64(idx, b * TelemetryLogFormat.IndexEntryBytes);
+                    blockLast[b] = BitConverter.ToInt64(idx, b * TelemetryLogFormat.IndexEntryBytes + 8);
+                }
+            }
+            // Rebuild the missing tail from the block headers
+            for (int b = fromIndex; b < blockFirst.Length; b++) {
+                long o = BlockOffset(b);
+                if (view.ReadUInt32(o) != TelemetryLogFormat.BlockMagic) throw new InvalidDataException("Corrupt block " + b);
+                blockFirst[b] = view.ReadInt64(o + 8);
+                blockLast[b] = view.ReadInt64(o + 16);
+            }
+        }
+
+        static long BlockOffset(int b)
+        {
+            return TelemetryLogFormat.HeaderBytes + (long)b * TelemetryLogFormat.BlockBytes;
+        }
+
+        public int BlockCount { get { return blockCount.Length; } }
+        public long FirstTimeUs { get { return Count == 0 ? 0 : blockFirst[0]; } }
+        public long LastTimeUs { get { return Count == 0 ? 0 : blockLast[blockLast.Length - 1]; } }
+
+        // Global sample index -> (block, row)
+        int Locate(long i, out int row)
+        {
+            if (i < 0 || i >= Count) throw new ArgumentOutOfRangeException("i");
+            int b = (int)(i / TelemetryLogFormat.BlockSamples); // Exact unless a block is partial
+            while (b > 0 && blockStart[b] > i) b--;
+            while (blockStart[b] + blockCount[b] <= i) b++;
+            row = (int)(i - blockStart[b]);
+            return b;
+        }
+
+        public long TimeUs(long i)
+        {
+            int row, b = Locate(i, out row);
+            return view.ReadInt64(BlockOffset(b) + TelemetryLogFormat.TimeOffset + 8L * row);
+        }
+
+        public int Adc(long i)
+        {
+            int row, b = Locate(i, out row);
+            return view.ReadUInt16(BlockOffset(b) + TelemetryLogFormat.AdcOffset + 2L * row);
+        }
+
+        public TelemetrySample Sample(long i)
+        {
+            int row, b = Locate(i, out row);
+            long o = BlockOffset(b);
+            int clock = view.ReadInt32(o + TelemetryLogFormat.ClockOffset + 4L * row);
+            TelemetrySample s = new TelemetrySample();
+            s.Hour = (byte)(clock / 3600);
+            s.Minute = (byte)(clock / 60 % 60);
+            s.Second = (byte)(clock % 60);
+            s.Adc = view.ReadUInt16(o + TelemetryLogFormat.AdcOffset + 2L * row);
+            s.Button = view.ReadByte(o + TelemetryLogFormat.ButtonOffset + row) != 0;
+            return s;
+        }
+
+        // Copies ADC values [from, from + n) into dst; reads the column directly
+        public int ReadAdc(long from, ushort[] dst, int n)
+        {
+            int done = 0;
+            while (done < n && from + done < Count) {
+                int row, b = Locate(from + done, out row);
+                int take = Math.Min(n - done, blockCount[b] - row);
+                view.ReadArray(BlockOffset(b) + TelemetryLogFormat.AdcOffset + 2L * row, dst, done, take);
+                done += take;
+            }
+            return done;
+        }
+
+        // Index of the first sample with TimeUs >= t (Count if none).
+        // Binary search over the block index, then inside the block's time column.
+        public long Seek(long timeUs)
+        {
+            int lo = 0, hi = blockLast.Length;
+            while (lo < hi) {
+                int mid = (lo + hi) / 2;
+                if (blockLast[mid] < timeUs) lo = mid + 1; else hi = mid;
+            }
+            if (lo == blockLast.Length) return Count;
+
+            long o = BlockOffset(lo) + TelemetryLogFormat.TimeOffset;
+            int r0 = 0, r1 = blockCount[lo];
+            while (r0 < r1) {
+                int mid = (r0 + r1) / 2;
+                if (view.ReadInt64(o + 8L * mid) < timeUs) r0 = mid + 1; else r1 = mid;
+            }
+            return blockStart[lo] + r0;
+        }
+
+        public void Dispose()
+        {
+            view.Dispose();
+            map.Dispose();
+        }
+    }
+
+    // Turns a log back into the device's text reports ("HH:MM:SS;ADC;BTN\r\n")
+    // so replay goes through exactly the same TelemetryPipeline as the live
+    // link. Speed 1 = recorded timing, 10 = ten times faster, 0 = as fast as
+    // the pipeline can take it (load test).
+    public sealed class LogReplayStream : Stream
+    {
+        const int MaxLineBytes = 24;
+
+        readonly TelemetryLogReader log;
+        readonly byte[] carry = new byte[MaxLineBytes]; // Line the caller had no room for
+        int carryPos, carryLen;
+        readonly double speed;
+        long next;
+        long baseUs;
+        Stopwatch clock;
+
+        public LogReplayStream(TelemetryLogReader log, double speed, long startIndex)
+        {
+            this.log = log;
+            this.speed = speed;
+            next = startIndex;
+        }
+
+        public override int Read(byte[] buffer, int offset, int count)
+        {
+            return ReadAsync(buffer, offset, count, CancellationToken.None).GetAwaiter().GetResult();
+        }
+
+        public override async Task<int> ReadAsync(byte[] buffer, int offset, int count, CancellationToken ct)
+        {
+            if (count == 0) return 0;
+            if (carryPos < carryLen) return TakeCarry(buffer, offset, count);
+            if (clock == null) {
+                if (next >= log.Count) return 0;
+                baseUs = log.TimeUs(next);
+                clock = Stopwatch.StartNew();
+            }
+            while (true) {
+                if (next >= log.Count) return 0;
+
+                // Samples whose (scaled) time has come
+                long dueUs = (speed > 0) ? baseUs + (long)(clock.Elapsed.TotalMilliseconds * 1000 * speed) : long.MaxValue;
+                int pos = offset, end = offset + count;
+                while (pos < end && next < log.Count && log.TimeUs(next) <= dueUs) {
+                    if (end - pos >= MaxLineBytes) {
+                        pos = Format(log.Sample(next++), buffer, pos);
+                    } else {
+                        // Last line of this read: what fits now, the rest next time
+                        carryLen = Format(log.Sample(next++), carry, 0);
+                        carryPos = 0;
+                        pos += TakeCarry(buffer, pos, end - pos);
+                        break;
+                    }
+                }
+
+                if (pos > offset) return pos - offset;
+                await Task.Delay(1, ct).ConfigureAwait(false);
+            }
+        }
+
+        int TakeCarry(byte[] buffer, int offset, int count)
+        {
+            int n = Math.Min(count, carryLen - carryPos);
+            Buffer.BlockCopy(carry, carryPos, buffer, offset, n);
+            carryPos += n;
+            return n;
+        }
+
+        static int Format(TelemetrySample s, byte[] b, int p)
+        {
+            p = TwoDigits(s.Hour, b, p); b[p++] = (byte)':';
+            p = TwoDigits(s.Minute, b, p); b[p++] = (byte)':';
+            p = TwoDigits(s.Second, b, p); b[p++] = (byte)';';
+            int v = s.Adc, digits = 1;
+            for (int t = v; t >= 10; t /= 10) digits++;
+            for (int i = digits - 1; i >= 0; i--) { b[p + i] = (byte)('0' + v % 10); v /= 10; }
+            p += digits;
+            b[p++] = (byte)';';
+            b[p++] = (byte)(s.Button ? '1' : '0');
+            b[p++] = (byte)'\r';
+            b[p++] = (byte)'\n';
+            return p;
+        }
+
+        static int TwoDigits(int v, byte[] b, int p)
+        {
+            b[p] = (byte)('0' + v / 10 % 10);
+            b[p + 1] = (byte)('0' + v % 10);
+            return p + 2;
+        }
+
+        public override bool CanRead { get { return true; } }
+        public override bool CanSeek { get { return false; } }
+        public override bool CanWrite { get { return false; } }
+        public override long Length { get { throw new NotSupportedException(); } }
+        public override long Position { get { return next; } set { throw new NotSupportedException(); } }
+        public override void Flush() { }
+        public override long Seek(long offset, SeekOrigin origin) { throw new NotSupportedException(); }
+        public override void SetLength(long value) { throw new NotSupportedException(); }
+        public override void Write(byte[] buffer, int offset, int count) { throw new NotSupportedException(); }
+    }
+}
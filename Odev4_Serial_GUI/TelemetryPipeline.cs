@@ -0,0 +1,273 @@
+using System;
+using System.Buffers;
+using System.Collections.Concurrent;
+using System.Diagnostics;
+using System.IO;
+using System.Text;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace MicrocontrollerProject
+{
+    // Cihazdan gelen tek bir rapor (HH:MM:SS;ADC;BTN)
+    public struct TelemetrySample
+    {
+        public byte Hour, Minute, Second;
+        public int Adc;
+        public bool Button;
+        public long RxTicks;     // Stopwatch timestamp when the bytes were read
+        public long ParsedTicks; // Stopwatch timestamp when the sample was queued
+
+        // Latency mode only (device Micros): timer tick, ADC conversion, TX start
+        public bool HasStamps;
+        public uint TickUs, ConvUs, TxUs;
+
+        public string TimeText
+        {
+            get { return Hour.ToString("00") + ":" + Minute.ToString("00") + ":" + Second.ToString("00"); }
+        }
+    }
+
+    // Parses report lines straight from the received bytes (no string per line)
+    public static class TelemetryParser
+    {
+        // "12:00:05;2048;1" (trailing '\r' allowed)
+        // Latency mode: "12:00:05;2048;1;<tick us>;<conv us>;<tx us>"
+        public static bool TryParseReport(byte[] b, int off, int len, long rxTicks, out TelemetrySample s)
+        {
+            s = new TelemetrySample();
+            if (len > 0 && b[off + len - 1] == '\r') len--;
+            if (len < 12 || b[off + 2] != ':' || b[off + 5] != ':' || b[off + 8] != ';') return false;
+
+            int h, m, sec;
+            if (!TwoDigits(b, off, out h) || !TwoDigits(b, off + 3, out m) || !TwoDigits(b, off + 6, out sec)) return false;
+
+            int pos = off + 9, end = off + len, adc;
+            if (!Number(b, ref pos, end, out adc) || pos >= end || b[pos] != ';') return false;
+            pos++;
+            if (pos >= end || (b[pos] != '0' && b[pos] != '1')) return false;
+
+            s.Hour = (byte)h; s.Minute = (byte)m; s.Second = (byte)sec;
+            s.Adc = adc;
+            s.Button = b[pos] == '1';
+            s.RxTicks = rxTicks;
+
+            long tick, conv, tx;
+            pos++;
+            if (pos < end && b[pos] == ';') {
+                pos++;
+                if (!Number(b, ref pos, end, out tick) || pos >= end || b[pos++] != ';'
+                    || !Number(b, ref pos, end, out conv) || pos >= end || b[pos++] != ';'
+                    || !Number(b, ref pos, end, out tx)) return false;
+                s.HasStamps = true;
+                s.TickUs = (uint)tick; s.ConvUs = (uint)conv; s.TxUs = (uint)tx;
+            }
+            return true;
+        }
+
+        static bool TwoDigits(byte[] b, int i, out int v)
+        {
+            v = (b[i] - '0') * 10 + (b[i + 1] - '0');
+            return b[i] >= '0' && b[i] <= '9' && b[i + 1] >= '0' && b[i + 1] <= '9';
+        }
+
+        // Unsigned decimal, stops at the first non-digit
+        public static bool Number(byte[] b, ref int pos, int end, out int v)
+        {
+            int start = pos;
+            v = 0;
+            while (pos < end && b[pos] >= '0' && b[pos] <= '9') v = v * 10 + (b[pos++] - '0');
+            return pos > start;
+        }
+
+        // Same for values that do not fit in an int (32-bit device counters)
+        public static bool Number(byte[] b, ref int pos, int end, out long v)
+        {
+            int start = pos;
+            v = 0;
+            while (pos < end && b[pos] >= '0' && b[pos] <= '9' && pos - start < 18) v = v * 10 + (b[pos++] - '0');
+            return pos > start;
+        }
+    }
+
+    // Splits a byte stream into '\n' terminated lines inside one reused buffer
+    public sealed class LineFramer
+    {
+        public delegate void LineHandler(byte[] buffer, int offset, int length);
+
+        public const int MaxLine = 512;
+        readonly byte[] line = new byte[MaxLine];
+        int len;
+        bool overflow;
+        readonly LineHandler onLine;
+
+        public long OversizeLines;
+
+        public LineFramer(LineHandler onLine)
+        {
+            this.onLine = onLine;
+        }
+
+        public void Push(byte[] data, int offset, int count)
+        {
+            int end = offset + count;
+            while (offset < end) {
+                int nl = Array.IndexOf(data, (byte)'\n', offset, end - offset);
+                int stop = (nl < 0) ? end : nl;
+                int n = stop - offset;
+
+                if (len + n > MaxLine) overflow = true;
+                else { Buffer.BlockCopy(data, offset, line, len, n); len += n; }
+
+                if (nl < 0) return; // Line continues in the next chunk
+
+                if (overflow) OversizeLines++;
+                else if (len > 0) onLine(line, 0, len);
+                len = 0;
+                overflow = false;
+                offset = nl + 1;
+            }
+        }
+    }
+
+    // Background receive pipeline:
+    //   stage 1 (reader) : Stream.ReadAsync into pooled buffers -> chunk queue
+    //   stage 2 (parser) : chunks -> LineFramer -> samples / text lines
+    // Both outputs are lock-free queues that the UI drains at its own pace.
+    // Nothing here touches WinForms, so it runs (and can be tested) headless
+    // on any stream: a serial port, a pseudo-terminal or a MemoryStream.
+    public sealed class TelemetryPipeline
+    {
+        struct Chunk { public byte[] Buffer; public int Count; public long Ticks; }
+
+        public const int ReadSize = 4096;
+        public int MaxQueuedSamples = 200000; // Beyond this, new samples are dropped
+
+        readonly Stream stream;
+        readonly ArrayPool<byte> pool = ArrayPool<byte>.Shared;
+        readonly ConcurrentQueue<Chunk> chunks = new ConcurrentQueue<Chunk>();
+        readonly SemaphoreSlim chunkReady = new SemaphoreSlim(0);
+        readonly ConcurrentQueue<TelemetrySample> samples = new ConcurrentQueue<TelemetrySample>();
+        readonly LineFramer framer;
+        CancellationTokenSource cts;
+        Task readerTask, parserTask;
+        int queuedSamples;
+        int pendingChunks; // Read but not parsed yet
+        long chunkTicks;   // Read time of the chunk being parsed
+
+        // Non-report lines (BOOT;..., D;..., TRACE;...) for the UI to route
+        public readonly ConcurrentQueue<string> TextLines = new ConcurrentQueue<string>();
+
+        // Optional recorder; gets every parsed report, including dropped ones
+        public TelemetryLogWriter Recorder;
+
+        // Optional clock sync; gets the 'Q;<micros>' replies (not queued as text)
+        public ClockSync Clock;
+
+        // Statistics
+        public long BytesRead, SamplesParsed, BadLines, DroppedSamples;
+        public Exception LastError;
+
+        public TelemetryPipeline(Stream stream)
+        {
+            this.stream = stream;
+            framer = new LineFramer(OnLine);
+        }
+
+        public long OversizeLines { get { return framer.OversizeLines; } }
+        public bool Running { get { return readerTask != null && !readerTask.IsCompleted; } }
+
+        public void Start()
+        {
+            cts = new CancellationTokenSource();
+            readerTask = Task.Run(() => ReadLoop(cts.Token));
+            parserTask = Task.Run(() => ParseLoop(cts.Token));
+        }
+
+        // Stops both stages. Close the underlying port/stream afterwards so a
+        // read that ignores cancellation (serial ports do) returns as well.
+        public void Stop()
+        {
+            if (cts == null) return;
+            cts.Cancel();
+            chunkReady.Release();
+        }
+
+        // Waits until everything read so far has been parsed (for tests/replay)
+        public void WaitIdle()
+        {
+            while (Volatile.Read(ref pendingChunks) > 0) Thread.Sleep(1);
+        }
+
+        public bool TryTakeSample(out TelemetrySample s)
+        {
+            if (!samples.TryDequeue(out s)) return false;
+            Interlocked.Decrement(ref queuedSamples);
+            return true;
+        }
+
+        async Task ReadLoop(CancellationToken ct)
+        {
+            try {
+                while (!ct.IsCancellationRequested) {
+                    byte[] buf = pool.Rent(ReadSize);
+                    int n = await stream.ReadAsync(buf, 0, ReadSize, ct).ConfigureAwait(false);
+                    if (n <= 0) { pool.Return(buf); break; } // End of stream
+                    Interlocked.Add(ref BytesRead, n);
+                    Interlocked.Increment(ref pendingChunks);
+                    chunks.Enqueue(new Chunk { Buffer = buf, Count = n, Ticks = Stopwatch.GetTimestamp() });
+                    chunkReady.Release();
+                }
+            }
+            catch (OperationCanceledException) { }
+            catch (Exception ex) {
+                // Port closed under us is the normal way out of a blocked read
+                if (!ct.IsCancellationRequested) LastError = ex;
+            }
+        }
+
+        async Task ParseLoop(CancellationToken ct)
+        {
+            try {
+                while (true) {
+                    await chunkReady.WaitAsync(ct).ConfigureAwait(false);
+                    Chunk c;
+                    while (chunks.TryDequeue(out c)) {
+                        chunkTicks = c.Ticks;
+                        framer.Push(c.Buffer, 0, c.Count);
+                        pool.Return(c.Buffer);
+                        Interlocked.Decrement(ref pendingChunks);
+                    }
+                }
+            }
+            catch (OperationCanceledException) { }
+            catch (Exception ex) { LastError = ex; }
+        }
+
+        void OnLine(byte[] b, int off, int len)
+        {
+            TelemetrySample s;
+            if (TelemetryParser.TryParseReport(b, off, len, chunkTicks, out s)) {
+                SamplesParsed++;
+                TelemetryLogWriter rec = Recorder;
+                if (rec != null) rec.Append(ref s);
+                if (Interlocked.Increment(ref queuedSamples) > MaxQueuedSamples) {
+                    Interlocked.Decrement(ref queuedSamples);
+                    DroppedSamples++;
+                    return;
+                }
+                s.ParsedTicks = Stopwatch.GetTimestamp();
+                samples.Enqueue(s);
+            }
+            else if (len > 0 && b[off] >= '0' && b[off] <= '9') {
+                BadLines++; // Looked like a report but did not parse
+            }
+            else if (Clock != null && Clock.TryReply(b, off, len, chunkTicks)) {
+                // Clock reply consumed
+            }
+            else {
+                TextLines.Enqueue(Encoding.ASCII.GetString(b, off, len).TrimEnd('\r'));
+            }
+        }
+    }
+}
@@ -0,0 +1,315 @@
+using System;
+using System.Collections.Generic;
+using System.Drawing;
+using System.Globalization;
+using System.Text;
+using System.Windows.Forms;
+
+namespace MicrocontrollerProject
+{
+    // Tiva C trace ring'inden gelen tek bir kayıt (trace.h -> trace_rec_t)
+    public struct TraceRecord
+    {
+        public ushort Id;
+        public uint Cycles;   // DWT cycle counter (wraps)
+        public ushort Arg;
+        public double TimeUs; // Unwrapped time since the first record
+    }
+
+    // Latency statistics for one kind of span (BEGIN -> END)
+    public class TraceSpanStats
+    {
+        public string Name;
+        public int Count;
+        public double MinUs, AvgUs, P99Us, MaxUs;
+    }
+
+    // Collects the 'T' command dump and turns it into a timeline:
+    //     TRACE;<count>;<cpu_hz>
+    //     T;<id>;<cycles>;<arg>      (hex)
+    //     TRACE;END
+    // No UI code here, so it can be used from tools and tests as well.
+    public class TraceDump
+    {
+        public readonly List<TraceRecord> Records = new List<TraceRecord>();
+        public uint CpuHz = 80000000;
+        public int Expected;
+        public bool Complete;
+
+        // Event ids from trace.h. Ids 0x10+ are pairs: even = begin, odd = end.
+        public const ushort TimerIsr = 0x01, CmdRx = 0x02, Clock = 0x03, UartEnd = 0x13;
+
+        public static string EventName(ushort id)
+        {
+            switch (id & 0xFFFE) {
+                case 0x00: return (id == TimerIsr) ? "TIMER0" : "?";
+                case 0x02: return (id == CmdRx) ? "CMD" : "CLOCK";
+                case 0x10: return "ADC";
+                case 0x12: return "UART";
+                case 0x14: return "LCD";
+                case 0x16: return "SCROLL";
+                default: return "EV" + id.ToString("X2");
+            }
+        }
+
+        public static bool IsSpanBegin(ushort id) { return id >= 0x10 && (id & 1) == 0; }
+        public static bool IsSpanEnd(ushort id) { return id >= 0x10 && (id & 1) == 1; }
+
+        // Returns true if the line belongs to the dump (caller should not parse it further)
+        public bool Feed(string line)
+        {
+            line = line.Trim();
+            string[] p = line.Split(';');
+
+            if (p[0] == "TRACE") {
+                if (p.Length >= 2 && p[1] == "END") {
+                    Complete = true;
+                    Unwrap();
+                } else if (p.Length >= 3) {
+                    Records.Clear();
+                    Complete = false;
+                    Expected = int.Parse(p[1], CultureInfo.InvariantCulture);
+                    CpuHz = uint.Parse(p[2], CultureInfo.InvariantCulture);
+                }
+                return true;
+            }
+
+            if (p[0] == "T" && p.Length == 4) {
+                TraceRecord r = new TraceRecord();
+                r.Id = ushort.Parse(p[1], NumberStyles.HexNumber);
+                r.Cycles = uint.Parse(p[2], NumberStyles.HexNumber);
+                r.Arg = ushort.Parse(p[3], NumberStyles.HexNumber);
+                Records.Add(r);
+                return true;
+            }
+            return false;
+        }
+
+        // Converts wrapping cycle stamps to microseconds from the first record.
+        // The signed difference survives counter wrap (gaps < 26 s at 80 MHz)
+        // and the small reordering caused by an ISR preempting a TRACE call.
+        // The header carries the clock at dump time; CLOCK records (arg =
+        // old MHz << 8 | new MHz, governor.h) give the rate before and after
+        // each switch.
+        void Unwrap()
+        {
+            double usPerCycle = 1e6 / CpuHz;
+            foreach (TraceRecord r in Records) {
+                if (r.Id == Clock && (r.Arg >> 8) != 0) { usPerCycle = 1.0 / (r.Arg >> 8); break; }
+            }
+            double t = 0;
+            for (int i = 0; i < Records.Count; i++) {
+                TraceRecord r = Records[i];
+                if (i > 0) t += (int)(r.Cycles - Records[i - 1].Cycles) * usPerCycle;
+                if (r.Id == Clock && (r.Arg & 0xFF) != 0) usPerCycle = 1.0 / (r.Arg & 0xFF);
+                r.TimeUs = t;
+                Records[i] = r;
+            }
+        }
+
+        public double DurationUs
+        {
+            get { return Records.Count == 0 ? 0 : Records[Records.Count - 1].TimeUs; }
+        }
+
+        // Pairs every BEGIN with the next END of the same kind
+        public List<KeyValuePair<TraceRecord, TraceRecord>> Spans()
+        {
+            var spans = new List<KeyValuePair<TraceRecord, TraceRecord>>();
+            var open = new Dictionary<ushort, TraceRecord>();
+            foreach (TraceRecord r in Records) {
+                if (IsSpanBegin(r.Id)) {
+                    open[r.Id] = r;
+                } else if (IsSpanEnd(r.Id)) {
+                    TraceRecord b;
+                    ushort beginId = (ushort)(r.Id - 1);
+                    if (open.TryGetValue(beginId, out b)) {
+                        spans.Add(new KeyValuePair<TraceRecord, TraceRecord>(b, r));
+                        open.Remove(beginId);
+                    }
+                }
+            }
+            return spans;
+        }
+
+        // Per-span latency plus "timer tick -> report sent"
+        public List<TraceSpanStats> SpanStats()
+        {
+            var groups = new SortedDictionary<string, List<double>>();
+            foreach (var s in Spans()) {
+                string name = EventName(s.Key.Id);
+                if (!groups.ContainsKey(name)) groups[name] = new List<double>();
+                groups[name].Add(s.Value.TimeUs - s.Key.TimeUs);
+            }
+
+            var tickToReport = new List<double>();
+            double tick = -1;
+            foreach (TraceRecord r in Records) {
+                if (r.Id == TimerIsr) tick = r.TimeUs;
+                else if (r.Id == UartEnd && tick >= 0) { tickToReport.Add(r.TimeUs - tick); tick = -1; }
+            }
+            if (tickToReport.Count > 0) groups["TIMER0 -> UART end"] = tickToReport;
+
+            var result = new List<TraceSpanStats>();
+            foreach (var g in groups) result.Add(Stats(g.Key, g.Value));
+            return result;
+        }
+
+        static TraceSpanStats Stats(string name, List<double> d)
+        {
+            d.Sort();
+            double sum = 0;
+            foreach (double x in d) sum += x;
+            TraceSpanStats s = new TraceSpanStats();
+            s.Name = name;
+            s.Count = d.Count;
+            s.MinUs = d[0];
+            s.MaxUs = d[d.Count - 1];
+            s.AvgUs = sum / d.Count;
+            s.P99Us = d[Math.Max(0, (int)Math.Ceiling(d.Count * 0.99) - 1)];
+            return s;
+        }
+
+        public string StatsText()
+        {
+            StringBuilder sb = new StringBuilder();
+            sb.AppendFormat("{0} records, {1:F1} ms, CPU {2} MHz\r\n", Records.Count, DurationUs / 1000, CpuHz / 1000000);
+            sb.AppendLine(string.Format("{0,-20}{1,7}{2,12}{3,12}{4,12}{5,12}", "span", "count", "min us", "avg us", "p99 us", "max us"));
+            foreach (TraceSpanStats s in SpanStats()) {
+                sb.AppendLine(string.Format(CultureInfo.InvariantCulture, "{0,-20}{1,7}{2,12:F1}{3,12:F1}{4,12:F1}{5,12:F1}",
+                    s.Name, s.Count, s.MinUs, s.AvgUs, s.P99Us, s.MaxUs));
+            }
+            return sb.ToString();
+        }
+    }
+
+    // Timeline: one lane per event kind. Spans are bars, point events are ticks.
+    // Mouse wheel zooms around the cursor, dragging pans.
+    public class TraceTimeline : Control
+    {
+        TraceDump dump;
+        double viewStartUs, viewLenUs = 1;
+        int dragX = -1;
+        double dragStartUs;
+
+        static readonly string[] Lanes = { "TIMER0", "CMD", "CLOCK", "ADC", "UART", "LCD", "SCROLL" };
+        static readonly Color[] LaneColors = { Color.Firebrick, Color.DarkOrange, Color.Teal, Color.SeaGreen, Color.RoyalBlue, Color.MediumPurple, Color.Gray };
+        const int LaneHeight = 28, LabelWidth = 60;
+
+        public TraceTimeline()
+        {
+            DoubleBuffered = true;
+            BackColor = Color.White;
+        }
+
+        public void SetDump(TraceDump d)
+        {
+            dump = d;
+            viewStartUs = 0;
+            viewLenUs = Math.Max(1, d.DurationUs);
+            Invalidate();
+        }
+
+        float X(double us)
+        {
+            return LabelWidth + (float)((us - viewStartUs) / viewLenUs * (Width - LabelWidth));
+        }
+
+        static int Lane(ushort id)
+        {
+            return Array.IndexOf(Lanes, TraceDump.EventName(id));
+        }
+
+        protected override void OnPaint(PaintEventArgs e)
+        {
+            Graphics g = e.Graphics;
+            g.Clear(BackColor);
+            for (int i = 0; i < Lanes.Length; i++) {
+                g.DrawString(Lanes[i], Font, Brushes.Black, 2, i * LaneHeight + 8);
+                g.DrawLine(Pens.Gainsboro, LabelWidth, (i + 1) * LaneHeight, Width, (i + 1) * LaneHeight);
+            }
+            if (dump == null) return;
+
+            foreach (var s in dump.Spans()) {
+                int lane = Lane(s.Key.Id);
+                if (lane < 0) continue;
+                float x0 = X(s.Key.TimeUs), x1 = X(s.Value.TimeUs);
+                if (x1 < LabelWidth || x0 > Width) continue;
+                using (SolidBrush b = new SolidBrush(LaneColors[lane]))
+                    g.FillRectangle(b, Math.Max(x0, LabelWidth), lane * LaneHeight + 6, Math.Max(1, x1 - x0), LaneHeight - 12);
+            }
+            foreach (TraceRecord r in dump.Records) {
+                if (TraceDump.IsSpanBegin(r.Id) || TraceDump.IsSpanEnd(r.Id)) continue;
+                int lane = Lane(r.Id);
+                float x = X(r.TimeUs);
+                if (lane < 0 || x < LabelWidth || x > Width) continue;
+                using (Pen p = new Pen(LaneColors[lane], 2))
+                    g.DrawLine(p, x, lane * LaneHeight + 4, x, (lane + 1) * LaneHeight - 4);
+            }
+
+            string scale = string.Format(CultureInfo.InvariantCulture, "{0:F1} ms .. {1:F1} ms",
+                viewStartUs / 1000, (viewStartUs + viewLenUs) / 1000);
+            g.DrawString(scale, Font, Brushes.Black, LabelWidth, Lanes.Length * LaneHeight + 4);
+        }
+
+        protected override void OnMouseWheel(MouseEventArgs e)
+        {
+            if (dump == null || e.X < LabelWidth) return;
+            double atUs = viewStartUs + (e.X - LabelWidth) * viewLenUs / (Width - LabelWidth);
+            double factor = (e.Delta > 0) ? 0.8 : 1.25;
+            viewLenUs = Math.Max(1, Math.Min(dump.DurationUs, viewLenUs * factor));
+            viewStartUs = atUs - (e.X - LabelWidth) * viewLenUs / (Width - LabelWidth);
+            Invalidate();
+        }
+
+        protected override void OnMouseDown(MouseEventArgs e)
+        {
+            dragX = e.X;
+            dragStartUs = viewStartUs;
+            Focus(); // Wheel events go to the focused control
+        }
+
+        protected override void OnMouseMove(MouseEventArgs e)
+        {
+            if (dragX < 0 || dump == null) return;
+            viewStartUs = dragStartUs - (e.X - dragX) * viewLenUs / (Width - LabelWidth);
+            Invalidate();
+        }
+
+        protected override void OnMouseUp(MouseEventArgs e)
+        {
+            dragX = -1;
+        }
+    }
+
+    // Trace penceresi: üstte zaman çizelgesi, altta gecikme istatistikleri
+    public class TraceViewerForm : Form
+    {
+        readonly TraceTimeline timeline = new TraceTimeline();
+        readonly TextBox txtStats = new TextBox();
+
+        public TraceViewerForm()
+        {
+            Text = "Trace Viewer";
+            Size = new Size(900, 450);
+
+            txtStats.Multiline = true;
+            txtStats.ReadOnly = true;
+            txtStats.ScrollBars = ScrollBars.Vertical;
+            txtStats.Font = new Font(FontFamily.GenericMonospace, 9);
+            txtStats.Dock = DockStyle.Bottom;
+            txtStats.Height = 150;
+
+            timeline.Dock = DockStyle.Fill;
+
+            Controls.Add(timeline);
+            Controls.Add(txtStats);
+        }
+
+        public void LoadDump(TraceDump dump)
+        {
+            timeline.SetDump(dump);
+            txtStats.Text = dump.StatsText();
+        }
+    }
+}
@@ -0,0 +1,186 @@
+// ============================================================================
+//                  ADC CALIBRATION (ENGINEERING UNITS, INTEGER)
+// ============================================================================
+// Each ADC channel has a table of CAL_POINTS values at raw counts 0, 256,
+// 512 ... 4096. A reading is converted by looking up its segment and
+// interpolating linearly inside it:
+//
+//     i = raw >> 8, f = raw & 255
+//     value = t[i] + (t[i+1] - t[i]) * f / 256
+//
+// One shift, one mask, one multiply, no floating point and no division, so
+// the report and the LCD show units for practically the same cost as raw
+// counts. The value is an integer with 'dec' implied decimals (1650 with
+// dec = 3 and unit "V" is 1.650 V).
+//
+// The default table is millivolts at CAL_VREF_MV, worked out by the
+// preprocessor (CAL_DEFAULT below), so it costs nothing at run time. The PC
+// can replace it, per channel:
+//
+//   K<ch>T<raw0>,<val0>,<raw1>,<val1>\n   two-point: the table is built from
+//                                         the line through both points
+//   K<ch>P<v0>,<v1>,...,<v16>\n           piecewise: the 17 table values
+//   K<ch>U<dec>,<unit>\n                  decimals (0-3) and unit (max 4 chars)
+//   K<ch>R                                back to the default (mV)
+//   K?                                    K;<ch>;<dec>;<unit>;<v0>,...,<v16>
+//
+// Every table value must stay within +-CAL_VALUE_MAX (what 'K' can parse).
+// A two-point line that leaves that range anywhere on 0..4096 is refused.
+// The tables are saved with the other settings in EEPROM (persist.h).
+// ============================================================================
+
+#ifndef _CALIB_H
+#define _CALIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define CAL_CHANNELS   1    // AIN0 (PE3); add a table per extra channel
+#define CAL_SHIFT      8
+#define CAL_STEP       (1 << CAL_SHIFT)      // Raw counts per table segment
+#define CAL_POINTS     (4096 / CAL_STEP + 1) // 17: raw 0 .. 4096
+#define CAL_UNIT_MAX   4
+#define CAL_VREF_MV    3300
+#define CAL_VALUE_MAX  999999999 // 9 digits; "-999999.999" + unit fits unitBuf
+
+// Default table entry i: millivolts at raw i * 256 (4096 extrapolates
+// one count past full scale, so the last segment interpolates correctly)
+#define CAL_DEFAULT(i) ((int32_t)(((i) * CAL_STEP * CAL_VREF_MV + 2047) / 4095))
+
+typedef struct {
+    int32_t t[CAL_POINTS];
+    uint8_t dec;                   // Implied decimals of t[]
+    char unit[CAL_UNIT_MAX + 1];
+    uint8_t pad[2];
+} cal_channel_t;
+
+#define CAL_DEFAULT_TABLE { \
+    { CAL_DEFAULT(0),  CAL_DEFAULT(1),  CAL_DEFAULT(2),  CAL_DEFAULT(3),  \
+      CAL_DEFAULT(4),  CAL_DEFAULT(5),  CAL_DEFAULT(6),  CAL_DEFAULT(7),  \
+      CAL_DEFAULT(8),  CAL_DEFAULT(9),  CAL_DEFAULT(10), CAL_DEFAULT(11), \
+      CAL_DEFAULT(12), CAL_DEFAULT(13), CAL_DEFAULT(14), CAL_DEFAULT(15), \
+      CAL_DEFAULT(16) },                                                  \
+    0, "mV", { 0, 0 } }
+
+const cal_channel_t cal_default = CAL_DEFAULT_TABLE;
+cal_channel_t cal[CAL_CHANNELS] = { CAL_DEFAULT_TABLE }; // One per channel
+
+char UART_Get();
+void UART_Print(char *str);
+
+// Raw ADC count (0-4095) -> calibrated value
+int32_t Cal_Convert(int ch, uint32_t raw) {
+    const int32_t *t = cal[ch].t + (raw >> CAL_SHIFT);
+    int32_t f = raw & (CAL_STEP - 1);
+    return t[0] + (int32_t)((((int64_t)t[1] - t[0]) * f) >> CAL_SHIFT); // SMULL
+}
+
+// Calibrated value -> "1.650V" (integer digits only, no printf float)
+char *Cal_Format(char *out, int ch, int32_t v) {
+    static const int32_t pow10[4] = { 1, 10, 100, 1000 };
+    int d = cal[ch].dec;
+    uint32_t a = (v < 0) ? -(uint32_t)v : (uint32_t)v;
+    if (d == 0) sprintf(out, "%s%u%s", v < 0 ? "-" : "", a, cal[ch].unit);
+    else sprintf(out, "%s%u.%0*u%s", v < 0 ? "-" : "", a / pow10[d], d, a % pow10[d], cal[ch].unit);
+    return out;
+}
+
+// Signed decimal up to ',' or end of line ('*end' gets the character)
+bool Cal_Read_Int(int32_t *value, char *end) {
+    int32_t v = 0;
+    int digits = 0;
+    bool neg = false;
+    char c = UART_Get();
+    if (c == '-') { neg = true; c = UART_Get(); }
+    while (c >= '0' && c <= '9') {
+        if (++digits <= 9) v = v * 10 + (c - '0');
+        c = UART_Get();
+    }
+    *value = neg ? -v : v;
+    *end = c;
+    return digits > 0 && digits <= 9 && (c == ',' || c == '\r' || c == '\n');
+}
+
+// Table from the line through (r0, v0) and (r1, v1), integer math.
+// False (table unchanged) if the line leaves +-CAL_VALUE_MAX.
+bool Cal_Two_Point(cal_channel_t *c, int32_t r0, int32_t v0, int32_t r1, int32_t v1) {
+    int32_t t[CAL_POINTS];
+    int64_t v;
+    int i;
+    for (i = 0; i < CAL_POINTS; i++) {
+        v = v0 + (int64_t)(i * CAL_STEP - r0) * ((int64_t)v1 - v0) / (r1 - r0);
+        if (v > CAL_VALUE_MAX || v < -CAL_VALUE_MAX) return false;
+        t[i] = (int32_t)v;
+    }
+    memcpy(c->t, t, sizeof(t));
+    return true;
+}
+
+// Bad 'K' line: skips what is left of it, so the rest is never taken as
+// commands. 'last' is the last character already read.
+bool Cal_Reject(char last) {
+    while (last != '\r' && last != '\n') last = UART_Get();
+    return false;
+}
+
+// 'K' command (the letter is already read)
+bool Cal_Command(char *buf) {
+    int32_t v[CAL_POINTS];
+    cal_channel_t next;
+    char ch = UART_Get(), op, end = ',';
+    int i, n = 0;
+    bool bad = false;
+
+    if (ch == '?') {
+        for (i = 0; i < CAL_CHANNELS; i++) {
+            char *p = buf + sprintf(buf, "K;%d;%u;%s;", i, cal[i].dec, cal[i].unit);
+            for (n = 0; n < CAL_POINTS; n++) p += sprintf(p, n ? ",%d" : "%d", cal[i].t[n]);
+            sprintf(p, "\r\n");
+            UART_Print(buf);
+        }
+        return true;
+    }
+    if (ch < '0' || ch >= '0' + CAL_CHANNELS) return Cal_Reject(ch);
+    ch -= '0';
+    next = cal[(int)ch];
+    op = UART_Get();
+
+    if (op == 'R') {
+        cal[(int)ch] = cal_default;
+        return true;
+    }
+    if (op == 'U') {
+        if (!Cal_Read_Int(&v[0], &end) || end != ',' || v[0] < 0 || v[0] > 3) return Cal_Reject(end);
+        next.dec = (uint8_t)v[0];
+        memset(next.unit, 0, sizeof(next.unit));
+        while (1) {
+            char c = UART_Get();
+            if (c == '\r' || c == '\n') break;
+            if (c == ';') bad = true; // Field separator of the 'K;' reply
+            else if (n < CAL_UNIT_MAX) next.unit[n++] = c;
+        }
+        if (bad) return false;
+        cal[(int)ch] = next;
+        return true;
+    }
+
+    // T and P: numbers separated by commas, end of line after the last one
+    n = (op == 'T') ? 4 : (op == 'P') ? CAL_POINTS : 0;
+    if (n == 0) return Cal_Reject(op);
+    for (i = 0; i < n; i++) {
+        if (!Cal_Read_Int(&v[i], &end)) return Cal_Reject(end);
+        if ((end == ',') != (i < n - 1)) return Cal_Reject(end);
+    }
+    if (op == 'T') {
+        if (v[0] == v[2]) return false; // Both points at the same raw count
+        if (!Cal_Two_Point(&next, v[0], v[1], v[2], v[3])) return false;
+    } else {
+        memcpy(next.t, v, sizeof(next.t));
+    }
+    cal[(int)ch] = next; // Main loop only, the report never sees half a table
+    return true;
+}
+
+#endif
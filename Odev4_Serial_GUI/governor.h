@@ -0,0 +1,211 @@
+// ============================================================================
+//                       CLOCK GOVERNOR (POWER LEVELS)
+// ============================================================================
+// Most of the time the device sends one report per second and waits, so it
+// does not need the PLL at 80 MHz. The governor measures how busy the main
+// loop is and moves the system clock between three levels:
+//
+//   level 0:  16 MHz  main oscillator, PLL off   (idle)
+//   level 1:  40 MHz  PLL / 5
+//   level 2:  80 MHz  PLL / 2.5                  (streaming, bursts)
+//
+// Busy time = compute time of main loop passes longer than GOV_IDLE_PASS_US
+// (an idle pass only polls flags and takes a few microseconds). Compute time
+// is the pass length minus the waits a faster clock cannot shorten: LCD
+// delays, UART bytes still arriving, the ADC, a full or draining transmit
+// queue (metrics_wait_us). Otherwise a burst of commands at 9600 baud would
+// look like load and raise the clock for nothing. Every GOV_WINDOW_MS the
+// busy share goes into a running average; above GOV_UP_PCT the clock goes
+// one level up, below GOV_DOWN_PCT (and after GOV_HOLD_MS at the level) one
+// level down. Trace dumps and fast links (>= 230400 baud) jump straight to
+// the top level.
+//
+// On every switch everything derived from the clock is set again:
+// SysTick period, Timer0 reload, UART baud divisor, LED PWM period and
+// sample timer, the metrics/LCD delay scaling (sys_clk_hz). The ADC runs
+// from PIOSC, so it is not affected.
+//
+// 'G' command: GA = automatic (default), G0 / G1 / G2 = pin a level.
+// The 'D' frame carries the level, the time spent at each level and an
+// average current estimate. The mA figures are rough typical values for
+// the TM4C123 running from flash, good for comparing settings, not a
+// measurement.
+// ============================================================================
+
+#ifndef _GOVERNOR_H
+#define _GOVERNOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "inc/hw_nvic.h" // NVIC_ST_CURRENT (SysTick)
+
+#define GOV_WINDOW_MS     100 // Utilization sample window
+#define GOV_IDLE_PASS_US  100 // Longer main loop passes count as busy
+#define GOV_UP_PCT        75
+#define GOV_DOWN_PCT      25
+#define GOV_HOLD_MS       1000 // Minimum time at a level before stepping down
+#define GOV_BURST_BAUD    230400
+#define GOV_AUTO          (-1)
+
+typedef struct {
+    uint32_t config;  // SysCtlClockSet argument
+    uint32_t hz;
+    uint32_t ma_x10;  // Typical run current (mA x 10), estimate only
+} gov_level_t;
+
+const gov_level_t gov_levels[] = {
+    { SYSCTL_SYSDIV_1   | SYSCTL_USE_OSC | SYSCTL_OSC_MAIN | SYSCTL_XTAL_16MHZ, 16000000, 120 },
+    { SYSCTL_SYSDIV_5   | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN | SYSCTL_XTAL_16MHZ, 40000000, 220 },
+    { SYSCTL_SYSDIV_2_5 | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN | SYSCTL_XTAL_16MHZ, 80000000, 380 },
+};
+#define GOV_LEVEL_COUNT (sizeof(gov_levels) / sizeof(gov_levels[0]))
+#define GOV_TOP         (GOV_LEVEL_COUNT - 1)
+
+uint32_t gov_level = GOV_TOP;   // Current level (boot runs at the top)
+int gov_pinned = GOV_AUTO;      // 'G0'..'G2' pin a level
+uint32_t gov_util = 0;          // Averaged busy share (%)
+uint32_t gov_busy_us = 0;       // Busy time in the current window
+uint32_t gov_window_start = 0;  // ms_ticks at the start of the window
+uint32_t gov_level_since = 0;   // ms_ticks of the last switch
+uint32_t gov_last_ms = 0;       // For the residency counters
+volatile bool gov_timer_reload = false; // Timer0 runs a shortened period
+
+// Metrics ('D' frame)
+uint32_t m_gov_ms[GOV_LEVEL_COUNT]; // Time spent at each level (ms)
+uint32_t m_gov_switches = 0;
+uint32_t m_gov_ma_x10 = 0;          // Average current estimate (mA x 10)
+
+extern volatile uint32_t ms_ticks;
+extern uint32_t sys_clk_hz;
+extern uint32_t link_baud;
+extern bool link_verifying;
+extern bool trace_dumping;
+extern uint32_t metrics_cpu_mhz;
+extern uint32_t metrics_last_cycles;
+char UART_Get();
+void Led_Retime(); // led_pwm.h
+bool Persist_Busy(); // persist.h
+void Tx_Flush();     // uart_tx.h
+bool Tx_Idle();
+
+// Switches the system clock and re-derives everything that depends on it.
+// The transmit queue is drained first so no byte leaves at a half-changed
+// rate (it needs the UART0 interrupt, so before interrupts go off).
+void Gov_Set_Level(uint32_t level) {
+    uint32_t old_hz = sys_clk_hz, left;
+
+    if (level >= GOV_LEVEL_COUNT || level == gov_level) return;
+
+    Tx_Flush();
+    IntMasterDisable();
+
+    // Timer0: what is left of the current second, counted in old clocks
+    left = TimerValueGet(TIMER0_BASE, TIMER_A);
+
+    SysCtlClockSet(gov_levels[level].config);
+    sys_clk_hz = gov_levels[level].hz;
+
+    // SysTick restarts its 1 ms period (loses less than one ms once).
+    // Clearing CURRENT also keeps Micros() from seeing a count above the
+    // new period.
+    SysTickPeriodSet(sys_clk_hz / 1000);
+    HWREG(NVIC_ST_CURRENT) = 0;
+
+    // Finish the running second at the new rate; the ISR puts the
+    // full one-second reload back
+    TimerLoadSet(TIMER0_BASE, TIMER_A, (uint32_t)((uint64_t)left * sys_clk_hz / old_hz));
+    gov_timer_reload = true;
+
+    Link_Set_Baud(link_baud);
+    Led_Retime();
+    metrics_cpu_mhz = sys_clk_hz / 1000000;
+    metrics_last_cycles = HWREG(DWT_CYCCNT); // The running pass was counted in old cycles
+
+    IntMasterEnable();
+
+    TRACE(TR_CLOCK, (old_hz / 1000000) << 8 | metrics_cpu_mhz);
+    gov_level = level;
+    gov_level_since = ms_ticks;
+    m_gov_switches++;
+}
+
+// Call from Timer0IntHandler
+void Gov_Timer_Tick() {
+    if (gov_timer_reload) {
+        gov_timer_reload = false;
+        TimerLoadSet(TIMER0_BASE, TIMER_A, sys_clk_hz);
+    }
+}
+
+// Updates the residency counters and the average current estimate
+void Gov_Account(uint32_t now_ms) {
+    uint64_t sum = 0, total = 0;
+    uint32_t i;
+
+    m_gov_ms[gov_level] += now_ms - gov_last_ms;
+    gov_last_ms = now_ms;
+
+    for (i = 0; i < GOV_LEVEL_COUNT; i++) {
+        sum += (uint64_t)m_gov_ms[i] * gov_levels[i].ma_x10;
+        total += m_gov_ms[i];
+    }
+    if (total) m_gov_ma_x10 = (uint32_t)(sum / total);
+}
+
+// Never in the middle of a baud change, an EEPROM write, a transmission
+// or with a command arriving
+bool Gov_Can_Switch() {
+    return !link_verifying && !Persist_Busy() && Tx_Idle() && !UARTCharsAvail(UART0_BASE);
+}
+
+// Call every main loop pass with the compute time of the previous pass
+void Gov_Poll(uint32_t pass_us, uint32_t now_ms) {
+    uint32_t util, target;
+
+    // A pinned level ('G0'..'G2') is applied on the first pass that allows it
+    if (gov_pinned != GOV_AUTO && (uint32_t)gov_pinned != gov_level && Gov_Can_Switch())
+        Gov_Set_Level(gov_pinned);
+
+    if (pass_us > GOV_IDLE_PASS_US) gov_busy_us += pass_us;
+    if (now_ms - gov_window_start < GOV_WINDOW_MS) return;
+
+    // Close the window
+    util = gov_busy_us / (now_ms - gov_window_start) / 10; // us per ms -> %
+    if (util > 100) util = 100;
+    gov_util = (gov_util * 7 + util) / 8;
+    gov_busy_us = 0;
+    gov_window_start = now_ms;
+    Gov_Account(now_ms);
+
+    // Pick the level
+    target = gov_level;
+    if (gov_pinned != GOV_AUTO) {
+        target = gov_pinned;
+    } else if (trace_dumping || link_baud >= GOV_BURST_BAUD) {
+        target = GOV_TOP;
+    } else if (gov_util > GOV_UP_PCT && gov_level < GOV_TOP) {
+        target = gov_level + 1;
+    } else if (gov_util < GOV_DOWN_PCT && gov_level > 0 &&
+               now_ms - gov_level_since >= GOV_HOLD_MS) {
+        target = gov_level - 1;
+    }
+
+    if (target == gov_level || !Gov_Can_Switch()) return;
+    Gov_Set_Level(target);
+}
+
+// 'G' command (the letter is already read): GA / G0..G2
+bool Gov_Command(void) {
+    char c = UART_Get();
+    if (c == 'A') {
+        gov_pinned = GOV_AUTO;
+    } else if (c >= '0' && c < '0' + (char)GOV_LEVEL_COUNT) {
+        gov_pinned = c - '0'; // Gov_Poll switches on its next pass, through the same guard
+    } else {
+        return false;
+    }
+    return true;
+}
+
+#endif
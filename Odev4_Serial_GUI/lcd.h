@@ -0,0 +1,396 @@
+// ============================================================================
+//                     HD44780 LCD DRIVER (4-BIT, PORT B)
+// ============================================================================
+// Connections (RW tied to GND):
+//   PB0 -> RS, PB1 -> E, PB4..PB7 -> D4..D7
+//   extra displays (LCD_DISPLAYS > 1): same RS/D4..D7, E on PB2 / PB3
+//
+// The controller has 40 columns of DDRAM per line, but only 16 of them are
+// visible on a 16x2 panel. The "display shift" command moves the visible
+// window over that memory, which is what the marquee uses to scroll text
+// with a single command per step.
+// ============================================================================
+
+// "Include Guard": Prevents this file from being included twice
+#ifndef _LCD_H
+#define _LCD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/gpio.h"
+#include "driverlib/sysctl.h"
+
+// ============================================================================
+//                             HARDWARE MAPPING
+// ============================================================================
+// LCD Connections: Using Port B
+#define LCD_PORT_BASE GPIO_PORTB_BASE
+#define RS GPIO_PIN_0 // Register Select
+#define E  GPIO_PIN_1 // Enable (display 0)
+// Data Pins (4-bit mode)
+#define D4 GPIO_PIN_4
+#define D5 GPIO_PIN_5
+#define D6 GPIO_PIN_6
+#define D7 GPIO_PIN_7
+
+// Further displays share RS and D4-D7 and only get their own Enable pin
+// (a controller ignores the bus while its E stays low).
+#define E1 GPIO_PIN_2 // Enable (display 1)
+#define E2 GPIO_PIN_3 // Enable (display 2)
+
+#ifndef LCD_DISPLAYS
+#define LCD_DISPLAYS 1 // Displays on the bus (1..3)
+#endif
+
+// ============================================================================
+//                             COMMANDS & GEOMETRY
+// ============================================================================
+#define LCD_CMD_CLEAR        0x01
+#define LCD_CMD_HOME         0x02 // Cursor home AND display shift reset
+#define LCD_CMD_ENTRY_MODE   0x06 // Increment cursor, no shift
+#define LCD_CMD_DISPLAY_ON   0x0C // Display ON, Cursor OFF, Blink OFF
+#define LCD_CMD_SHIFT_LEFT   0x18 // Move the visible window one column right
+#define LCD_CMD_FUNCTION_SET 0x28 // 4-bit data, 2-line display, 5x8 font
+#define LCD_CMD_SET_DDRAM    0x80 // Command to set cursor position
+
+// Main display (0): the views, the marquee and the glyph cache use it
+#define LCD_COLS      16   // Visible columns
+#define LCD_ROWS      2    // Visible rows
+#define LCD_DDRAM_COLS 40  // Columns of DDRAM per line (the shift "ring")
+
+// DDRAM address of column 0 of each visible row. Every panel is a 2-line
+// controller; 4-row panels show the second half of each DDRAM line as
+// rows 2 and 3.
+const uint8_t lcd_rows_2[]    = { 0x00, 0x40 };             // 8x2, 16x2, 20x2, 40x2
+const uint8_t lcd_rows_16x4[] = { 0x00, 0x40, 0x10, 0x50 };
+const uint8_t lcd_rows_20x4[] = { 0x00, 0x40, 0x14, 0x54 };
+
+// ============================================================================
+//                             TIMING
+// ============================================================================
+// The waits are given in microseconds and converted with the CURRENT system
+// clock, because the clock governor (governor.h) changes it at run time.
+// SysCtlDelay() takes 3 cycles per count. The wait is added to
+// metrics_wait_us: a faster clock does not shorten it, so the clock
+// governor must not count it as load.
+extern uint32_t sys_clk_hz;
+extern uint32_t metrics_wait_us; // metrics.h
+uint32_t Micros(); // main.c
+#define LCD_Delay_Us(us) do { metrics_wait_us += (us); SysCtlDelay((us) * (sys_clk_hz / 1000000) / 3); } while (0)
+
+// ============================================================================
+//                             FRAME BUFFERS
+// ============================================================================
+// After start-up nothing waits for an LCD any more. Renderers fill the BACK
+// buffer of the selected display with bus operations (LCD_Cmd / LCD_Data
+// between LCD_Frame_Begin and LCD_Frame_End) while LCD_Frame_Poll() sends
+// the FRONT buffers. When a front buffer is empty the two are swapped, so a
+// display always changes at frame boundaries.
+//
+// A periodic frame that finds the back buffer still waiting is late: the
+// display has not caught up with the previous one. It is dropped (counted,
+// nothing is rendered) and the next period draws fresh data instead.
+// State-changing frames (view change, new message, marquee step) are
+// appended to the waiting buffer instead, because the glyph cache and the
+// display shift must see every one of their operations.
+//
+// Bus operations keep their order, which the glyph cache relies on (CGRAM
+// upload first, then the DDRAM writes that use it).
+//
+// BUS ARBITER: writing one byte takes the shared bus for ~8 us, then the
+// controller is busy on its own for ~40 us. LCD_Frame_Poll() gives the bus
+// to every display whose previous operation has finished, so the other
+// controllers are written during that wait. N displays refresh in about
+// the time of one until N x 8 us exceeds the execution time.
+#define LCD_FRAME_OPS 256   // Bus operations per frame (largest frame ~120)
+#define LCD_OP_DATA   0x100 // Operation flag: RS = 1
+#define LCD_PULSE_US  2     // E high / low time (HD44780 needs 0.45 us)
+#define LCD_EXEC_US   50    // Execution time of data / most commands (37 us)
+#define LCD_SLOW_US   2000  // Clear and home (1.52 ms)
+
+typedef struct {
+    uint16_t op[LCD_FRAME_OPS];
+    uint16_t count;
+} lcd_frame_t;
+
+typedef struct {
+    uint8_t e_pin;            // Enable pin on LCD_PORT_BASE
+    uint8_t cols, rows;       // Visible geometry
+    const uint8_t *row_addr;  // DDRAM address of each row
+    lcd_frame_t frames[2];
+    lcd_frame_t *front;       // Being sent
+    lcd_frame_t *back;        // Being rendered / waiting
+    uint16_t front_pos;       // Next operation of the front frame
+    bool back_ready;          // Back frame complete, waiting for the swap
+    int depth;                // > 0 while a renderer fills the back frame
+    uint32_t due_us;          // The controller is busy until this time
+} lcd_display_t;
+
+lcd_display_t lcd_displays[LCD_DISPLAYS] = {
+    { .e_pin = E,  .cols = LCD_COLS, .rows = LCD_ROWS, .row_addr = lcd_rows_2 },    // Main display
+#if LCD_DISPLAYS > 1
+    { .e_pin = E1, .cols = 20,       .rows = 4,        .row_addr = lcd_rows_20x4 }, // Status panel
+#endif
+#if LCD_DISPLAYS > 2
+    { .e_pin = E2, .cols = 20,       .rows = 4,        .row_addr = lcd_rows_20x4 },
+#endif
+};
+lcd_display_t *lcd_cur = &lcd_displays[0]; // Target of LCD_Cmd / LCD_Data
+
+uint32_t lcd_bytes = 0;          // Bytes (commands + data) sent, all displays
+uint32_t lcd_frames_shown = 0;   // Frames swapped to the front
+uint32_t lcd_frames_dropped = 0; // Late periodic frames
+uint32_t lcd_frame_overflow = 0; // Operations that did not fit (frame too big)
+
+// Enable pins of every display (the start-up sequence goes to all at once)
+uint8_t LCD_All_E() {
+    uint8_t m = 0;
+    int i;
+    for (i = 0; i < LCD_DISPLAYS; i++) m |= lcd_displays[i].e_pin;
+    return m;
+}
+
+// Selects the display the next renderer calls go to
+void LCD_Select(int n) {
+    lcd_cur = &lcd_displays[n];
+}
+
+// ============================================================================
+//                             LOW LEVEL
+// ============================================================================
+// Blocking path, only used by the start-up sequence (frames are not running
+// yet). It talks to ALL displays at once.
+
+// Toggles the Enable pin(s) to latch data
+void LCD_Pulse_Enable() {
+    uint8_t e = LCD_All_E();
+    GPIOPinWrite(LCD_PORT_BASE, e, e); // High
+    LCD_Delay_Us(1500);                // Wait
+    GPIOPinWrite(LCD_PORT_BASE, e, 0); // Low
+    LCD_Delay_Us(1500);                // Wait
+}
+
+// Sends 4 bits to the LCD data pins
+void LCD_Write_4Bit(unsigned char data) {
+    // Write data to pins 4-7.
+    // (data << 4) shifts the value to match the pin positions (PB4-PB7).
+    GPIOPinWrite(LCD_PORT_BASE, D4|D5|D6|D7, (data << 4));
+    LCD_Pulse_Enable();
+}
+
+// One bus write to one display with short E pulses; the caller takes care
+// of the execution time
+void LCD_Bus_Write(uint8_t e_pin, uint16_t op) {
+    uint8_t b = (uint8_t)op;
+    int i;
+    lcd_bytes++;
+    GPIOPinWrite(LCD_PORT_BASE, RS, (op & LCD_OP_DATA) ? RS : 0);
+    for (i = 0; i < 2; i++) {
+        GPIOPinWrite(LCD_PORT_BASE, D4|D5|D6|D7, (i ? b : b >> 4) << 4);
+        GPIOPinWrite(LCD_PORT_BASE, e_pin, e_pin);
+        LCD_Delay_Us(LCD_PULSE_US);
+        GPIOPinWrite(LCD_PORT_BASE, e_pin, 0);
+        LCD_Delay_Us(LCD_PULSE_US);
+    }
+}
+
+// ============================================================================
+//                             FRAMES
+// ============================================================================
+// Starts (or, nested, continues) a frame on the selected display. 'must' =
+// append to a waiting frame instead of dropping. Returns false when the
+// frame is dropped.
+bool LCD_Frame_Begin(bool must) {
+    lcd_display_t *d = lcd_cur;
+    if (d->depth) { d->depth++; return true; }
+    if (d->back_ready && !must) { lcd_frames_dropped++; return false; }
+    d->back_ready = false; // Reopened until LCD_Frame_End
+    d->depth = 1;
+    return true;
+}
+
+void LCD_Frame_End() {
+    lcd_display_t *d = lcd_cur;
+    if (--d->depth == 0) d->back_ready = (d->back->count > 0);
+}
+
+void LCD_Frame_Put(uint16_t op) {
+    lcd_frame_t *f = lcd_cur->back;
+    if (f->count < LCD_FRAME_OPS) f->op[f->count++] = op;
+    else lcd_frame_overflow++;
+}
+
+// Bus arbiter. Call every main loop pass: each display whose controller is
+// free gets its next operation (~8 us of bus time each). The clock is read
+// again after every write, so a display served later in the pass still
+// gets its full execution time.
+void LCD_Frame_Poll(uint32_t now_us) {
+    lcd_frame_t *t;
+    lcd_display_t *d;
+    uint16_t op;
+    int i;
+
+    for (i = 0; i < LCD_DISPLAYS; i++) {
+        d = &lcd_displays[i];
+        if ((int32_t)(now_us - d->due_us) < 0) continue; // Still executing
+
+        if (d->front_pos == d->front->count) {
+            // Front frame done: swap at the frame boundary
+            if (!d->back_ready || d->depth) continue;
+            t = d->front; d->front = d->back; d->back = t;
+            d->back->count = 0;
+            d->front_pos = 0;
+            d->back_ready = false;
+            lcd_frames_shown++;
+        }
+
+        op = d->front->op[d->front_pos++];
+        LCD_Bus_Write(d->e_pin, op);
+        now_us = Micros(); // E has just fallen on this display
+        d->due_us = now_us + ((op == LCD_CMD_CLEAR || op == LCD_CMD_HOME) ? LCD_SLOW_US : LCD_EXEC_US);
+    }
+}
+
+// Sends a Command (RS = 0). Inside a frame it is only queued.
+void LCD_Cmd(unsigned char cmd) {
+    if (lcd_cur->depth) { LCD_Frame_Put(cmd); return; }
+    lcd_bytes++;
+    GPIOPinWrite(LCD_PORT_BASE, RS, 0); // RS Low = Command
+    LCD_Write_4Bit(cmd >> 4);           // Send Upper Nibble
+    LCD_Write_4Bit(cmd & 0x0F);         // Send Lower Nibble
+    LCD_Delay_Us(3000);                 // Wait for command to process
+}
+
+// Sends Data/Characters (RS = 1). Inside a frame it is only queued.
+void LCD_Data(unsigned char data) {
+    if (lcd_cur->depth) { LCD_Frame_Put(LCD_OP_DATA | data); return; }
+    lcd_bytes++;
+    GPIOPinWrite(LCD_PORT_BASE, RS, RS); // RS High = Data
+    LCD_Write_4Bit(data >> 4);           // Send Upper Nibble
+    LCD_Write_4Bit(data & 0x0F);         // Send Lower Nibble
+    LCD_Delay_Us(3000);                  // Wait
+}
+
+// ============================================================================
+//                      NON-BLOCKING INITIALIZATION
+// ============================================================================
+// The LCD needs >40ms after power-up, then the "magic" 0x03/0x03/0x03/0x02
+// wake-up sequence with waits in between. Instead of sleeping through those
+// windows, LCD_Init_Start() arms a state machine and LCD_Init_Poll() does
+// ONE step each time its deadline (in ms from the caller's tick) has passed.
+// The rest of the system (UART, ADC, timer, reports) runs in the meantime.
+int lcd_init_step = 0;      // Next step of the wake-up sequence
+uint32_t lcd_init_due = 0;  // Tick (ms) at which that step may run
+bool lcd_ready = false;     // TRUE once the display accepts text
+
+// Configures the pins and starts the power-up window of every display
+void LCD_Init_Start(uint32_t now_ms) {
+    int i;
+
+    // Enable Port B
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
+    // Set pins as Output
+    GPIOPinTypeGPIOOutput(LCD_PORT_BASE, 0xFF);
+    GPIOPinWrite(LCD_PORT_BASE, 0xFF, 0);
+
+    for (i = 0; i < LCD_DISPLAYS; i++) {
+        lcd_display_t *d = &lcd_displays[i];
+        d->frames[0].count = d->frames[1].count = 0;
+        d->front = &d->frames[0];
+        d->back = &d->frames[1];
+        d->front_pos = 0;
+        d->back_ready = false;
+        d->depth = 0;
+    }
+
+    lcd_init_step = 0;
+    lcd_init_due = now_ms + 40; // Wait for power up
+    lcd_ready = false;
+}
+
+// Runs the next init step if it is due. Returns TRUE when the LCD is ready.
+bool LCD_Init_Poll(uint32_t now_ms) {
+    uint32_t wait_ms = 0;
+
+    if (lcd_ready) return true;
+    if ((int32_t)(now_ms - lcd_init_due) < 0) return false; // Not yet
+
+    switch (lcd_init_step++) {
+        // "Magic" sequence to force 4-bit mode
+        case 0: LCD_Write_4Bit(0x03); wait_ms = 5; break;
+        case 1: LCD_Write_4Bit(0x03); wait_ms = 1; break;
+        case 2: LCD_Write_4Bit(0x03); wait_ms = 1; break;
+        case 3: LCD_Write_4Bit(0x02); wait_ms = 1; break; // 4-bit mode set
+
+        // Configure Display
+        case 4: LCD_Cmd(LCD_CMD_FUNCTION_SET); break; // 4-bit, 2 lines
+        case 5: LCD_Cmd(LCD_CMD_DISPLAY_ON);   break; // Display ON
+        case 6: LCD_Cmd(LCD_CMD_ENTRY_MODE);   break; // Cursor Auto-Increment
+        case 7: LCD_Cmd(LCD_CMD_CLEAR); wait_ms = 2; break; // Clear Screen
+
+        default: lcd_ready = true; break;
+    }
+
+    lcd_init_due = now_ms + wait_ms;
+    return lcd_ready;
+}
+
+// ============================================================================
+//                             HIGH LEVEL
+// ============================================================================
+// Prints a full string
+void LCD_Print(char *str) {
+    while(*str) LCD_Data(*str++);
+}
+
+// DDRAM address of column 'col' of a visible row of the selected display.
+// Columns wrap inside the row's 40-column DDRAM line (the shift ring), so
+// callers can address the ring directly. On 4-row panels row 2 starts in
+// the middle of line 0, so its ring position is offset by the row start.
+uint8_t LCD_Ddram_Addr(uint8_t row, uint8_t col) {
+    uint8_t start = lcd_cur->row_addr[row % lcd_cur->rows];
+    return (start & 0x40) + ((start & 0x3F) + col) % LCD_DDRAM_COLS;
+}
+
+// Moves the cursor to column 'col' of 'row' (see LCD_Ddram_Addr)
+void LCD_Goto(uint8_t row, uint8_t col) {
+    LCD_Cmd(LCD_CMD_SET_DDRAM + LCD_Ddram_Addr(row, col));
+}
+
+// Writes 'n' characters starting at column 'col' of 'row'.
+// In 2-line mode the address counter jumps from 0x27 to 0x40 (the NEXT line),
+// so when the text crosses the end of the DDRAM line we re-address the start
+// of the same line.
+void LCD_Write_Ring(uint8_t row, uint8_t col, const char *str, int n) {
+    uint8_t addr = LCD_Ddram_Addr(row, col);
+    int i;
+    LCD_Cmd(LCD_CMD_SET_DDRAM + addr);
+    for (i = 0; i < n; i++) {
+        if ((addr & 0x3F) == LCD_DDRAM_COLS) { addr &= 0x40; LCD_Cmd(LCD_CMD_SET_DDRAM + addr); }
+        LCD_Data(str[i]);
+        addr++;
+    }
+}
+
+// Writes a whole visible row of the selected display, padded with spaces
+void LCD_Print_Line(uint8_t row, const char *str) {
+    int i;
+    LCD_Goto(row, 0);
+    for (i = 0; i < lcd_cur->cols; i++) LCD_Data(*str ? *str++ : ' ');
+}
+
+// Moves the visible window one column to the right (text appears to move left).
+// This is ONE bus command no matter how much text is on the display.
+void LCD_Shift_Left() {
+    LCD_Cmd(LCD_CMD_SHIFT_LEFT);
+}
+
+// Cancels any display shift (window back to column 0)
+void LCD_Home() {
+    LCD_Cmd(LCD_CMD_HOME);
+    if (!lcd_cur->depth) LCD_Delay_Us(2000); // Home needs ~1.5ms (queued: see LCD_Frame_Poll)
+}
+
+#endif
@@ -0,0 +1,170 @@
+// ============================================================================
+//                  CGRAM GLYPH CACHE + BIG DIGITS + BAR GRAPH
+// ============================================================================
+// The HD44780 has 8 user-definable characters (CGRAM slots, codes 0-7).
+// Uploading one costs 9 bus writes (1 address command + 8 pattern rows),
+// so the views below never upload blindly. They ask the cache for a glyph:
+//   - already in a slot  -> the slot number is returned, no bus traffic
+//   - missing            -> the least recently used slot is overwritten
+// Slots used by the frame being drawn are "pinned" so a frame can never
+// evict its own glyphs (renderers touch every glyph still on screen).
+// After warm-up a frame costs the same as plain text.
+//
+// Drawing order matters: a CGRAM upload moves the LCD address counter into
+// CGRAM, so a renderer first resolves ALL its glyphs, then sets the cursor
+// and writes the characters.
+// ============================================================================
+
+#ifndef _LCD_GLYPH_H
+#define _LCD_GLYPH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lcd.h"
+
+#define LCD_CMD_SET_CGRAM 0x40 // + (slot << 3)
+#define GLYPH_SLOTS       8
+#define GLYPH_NONE        0xFF // "slot is empty"
+
+// Cell codes used by the renderers:
+// values below GLYPH_COUNT are custom glyphs, anything else is a ROM character.
+#define CELL_FULL  0xFF // ROM: solid block
+#define CELL_BLANK ' '  // ROM: space
+
+// ============================================================================
+//                             GLYPH PATTERNS
+// ============================================================================
+enum {
+    // Big digit segments (3x2 cells per digit)
+    G_LT, G_UB, G_RT, G_LL, G_LB, G_LR, G_UMB,
+    // Bar graph: cell with 1..4 of its 5 pixel columns filled
+    G_BAR1, G_BAR2, G_BAR3, G_BAR4,
+    GLYPH_COUNT
+};
+
+const uint8_t glyph_rom[GLYPH_COUNT][8] = {
+    { 0x07, 0x0F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F }, // G_LT  upper-left corner
+    { 0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00 }, // G_UB  upper bar
+    { 0x1C, 0x1E, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F }, // G_RT  upper-right corner
+    { 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x0F, 0x07 }, // G_LL  lower-left corner
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F }, // G_LB  lower bar
+    { 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1E, 0x1C }, // G_LR  lower-right corner
+    { 0x1F, 0x1F, 0x1F, 0x00, 0x00, 0x00, 0x1F, 0x1F }, // G_UMB upper + middle bar
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 }, // G_BAR1
+    { 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18 }, // G_BAR2
+    { 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C }, // G_BAR3
+    { 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E }, // G_BAR4
+};
+
+// Big digits: 3 cells on the top row, 3 cells on the bottom row
+const uint8_t big_digit[10][6] = {
+    { G_LT,  G_UB,  G_RT,       G_LL,  G_LB,  G_LR      }, // 0
+    { G_UB,  G_RT,  CELL_BLANK, G_LB,  CELL_FULL, G_LB  }, // 1
+    { G_UMB, G_UMB, G_RT,       G_LL,  G_LB,  G_LB      }, // 2
+    { G_UMB, G_UMB, G_RT,       G_LB,  G_LB,  G_LR      }, // 3
+    { G_LL,  G_LB,  CELL_FULL,  CELL_BLANK, CELL_BLANK, CELL_FULL }, // 4
+    { G_LL,  G_UMB, G_UMB,      G_LB,  G_LB,  G_LR      }, // 5
+    { G_LT,  G_UMB, G_UMB,      G_LL,  G_LB,  G_LR      }, // 6
+    { G_UB,  G_UB,  G_RT,       CELL_BLANK, CELL_BLANK, CELL_FULL }, // 7
+    { G_LT,  G_UMB, G_RT,       G_LL,  G_LB,  G_LR      }, // 8
+    { G_LT,  G_UMB, G_RT,       CELL_BLANK, CELL_BLANK, CELL_FULL }, // 9
+};
+
+// ============================================================================
+//                             CACHE STATE
+// ============================================================================
+uint8_t  slot_glyph[GLYPH_SLOTS] = { GLYPH_NONE, GLYPH_NONE, GLYPH_NONE, GLYPH_NONE,
+                                     GLYPH_NONE, GLYPH_NONE, GLYPH_NONE, GLYPH_NONE };
+uint32_t slot_stamp[GLYPH_SLOTS]; // Last use (bigger = more recent)
+uint32_t slot_frame[GLYPH_SLOTS]; // Frame number that last used the slot
+uint32_t glyph_clock = 0;         // Use counter for LRU stamps
+uint32_t glyph_frame = 1;         // Current frame number
+
+// Statistics
+uint32_t glyph_hits = 0;
+uint32_t glyph_uploads = 0;
+
+// Writes a glyph pattern into a CGRAM slot (9 bus writes)
+void Glyph_Upload(uint8_t slot, uint8_t id) {
+    int row;
+    LCD_Cmd(LCD_CMD_SET_CGRAM | (slot << 3));
+    for (row = 0; row < 8; row++) LCD_Data(glyph_rom[id][row]);
+    slot_glyph[slot] = id;
+    glyph_uploads++;
+}
+
+// Starts a new frame: glyphs of the previous frame become evictable again
+void Glyph_Frame_Begin() {
+    glyph_frame++;
+}
+
+// Returns the character code to write for a cell.
+// ROM characters pass straight through, custom glyphs are mapped to a slot.
+uint8_t Glyph_Get(uint8_t cell) {
+    int i, victim = -1;
+
+    if (cell >= GLYPH_COUNT) return cell; // ROM character
+
+    // 1. Hit?
+    for (i = 0; i < GLYPH_SLOTS; i++) {
+        if (slot_glyph[i] == cell) {
+            slot_stamp[i] = ++glyph_clock;
+            slot_frame[i] = glyph_frame;
+            glyph_hits++;
+            return i;
+        }
+    }
+
+    // 2. Miss: take the least recently used slot that this frame is not using
+    for (i = 0; i < GLYPH_SLOTS; i++) {
+        if (slot_frame[i] == glyph_frame) continue; // Pinned
+        if (victim < 0 || slot_stamp[i] < slot_stamp[victim]) victim = i;
+    }
+    if (victim < 0) return CELL_FULL; // Frame needs more than 8 glyphs
+
+    Glyph_Upload(victim, cell);
+    slot_stamp[victim] = ++glyph_clock;
+    slot_frame[victim] = glyph_frame;
+    return victim;
+}
+
+// ============================================================================
+//                             RENDERERS
+// ============================================================================
+// Draws one big digit with its top-left corner at column 'col'.
+// Glyphs are resolved every frame even when the digit did not change:
+// that keeps them pinned while they are on screen. DDRAM is only written
+// when 'changed' is true.
+void Big_Digit_Draw(uint8_t col, int digit, bool changed) {
+    uint8_t code[6];
+    int i;
+
+    // Resolve (and upload) first, then write
+    for (i = 0; i < 6; i++) code[i] = Glyph_Get(big_digit[digit][i]);
+    if (!changed) return;
+
+    LCD_Goto(0, col);
+    for (i = 0; i < 3; i++) LCD_Data(code[i]);
+    LCD_Goto(1, col);
+    for (i = 3; i < 6; i++) LCD_Data(code[i]);
+}
+
+// Draws a horizontal bar on 'row' for value (0..max), 5 levels per cell.
+// Full cells are the ROM block, so at most ONE custom glyph is needed.
+void Bar_Graph_Draw(uint8_t row, uint32_t value, uint32_t max) {
+    uint32_t levels = (uint32_t)LCD_COLS * 5;
+    uint32_t filled = (value >= max) ? levels : (value * levels) / max;
+    uint8_t partial = CELL_BLANK;
+    int i;
+
+    if (filled % 5) partial = Glyph_Get(G_BAR1 + (filled % 5) - 1);
+
+    LCD_Goto(row, 0);
+    for (i = 0; i < LCD_COLS; i++) {
+        if ((uint32_t)i < filled / 5)       LCD_Data(CELL_FULL);
+        else if ((uint32_t)i == filled / 5) LCD_Data(partial);
+        else                                LCD_Data(CELL_BLANK);
+    }
+}
+
+#endif
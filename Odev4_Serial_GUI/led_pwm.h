@@ -0,0 +1,199 @@
+// ============================================================================
+//                    RGB LED INDICATOR (PWM, ADC DRIVEN)
+// ============================================================================
+// The LaunchPad RGB LED shows the ADC level locally:
+//   PF1 (red)   -> M1PWM5 (PWM1 generator 2, B)
+//   PF2 (blue)  -> M1PWM6 (PWM1 generator 3, A)
+//   PF3 (green) -> M1PWM7 (PWM1 generator 3, B)
+//
+// The main loop is not involved. Timer1 triggers ADC0 sequencer 2 in
+// hardware LED_SAMPLE_HZ times a second. The sequence-complete interrupt
+// maps the sample to three duty cycles and writes them to the generators.
+// Sequencer 3 (the one-per-second report) stays processor triggered, so the
+// two do not share state.
+//
+// Each colour has a curve of LED_CURVE_POINTS duty values (per mille) at
+// evenly spaced ADC levels (0, 1024, 2048, 3072, 4095), linearly
+// interpolated in between. At or above the alarm level the LED blinks red
+// (2 Hz) until the input drops LED_ALARM_HYST below it again.
+//
+// 'W' command:
+//   WR<p0>,<p1>,<p2>,<p3>,<p4>\n   red curve   (also WG = green, WB = blue)
+//   WA<level>\n                    alarm level (0 = off)
+// ============================================================================
+
+#ifndef _LED_PWM_H
+#define _LED_PWM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "driverlib/pwm.h"
+
+#define LED_PWM_HZ        1000 // PWM frequency
+#define LED_SAMPLE_HZ     100  // ADC samples (and duty updates) per second
+#define LED_CURVE_POINTS  5
+#define LED_CURVE_SHIFT   10   // 4096 / (LED_CURVE_POINTS - 1) = 1 << 10
+#define LED_ALARM_HYST    64
+#define LED_RED   0
+#define LED_GREEN 1
+#define LED_BLUE  2
+
+// Default: green at the bottom, through yellow, to red at the top
+uint16_t led_curve[3][LED_CURVE_POINTS] = {
+    {    0,    0,  500, 1000, 1000 }, // Red
+    { 1000, 1000,  500,    0,    0 }, // Green
+    {    0,    0,    0,    0,    0 }, // Blue
+};
+const uint32_t led_out[3] = { PWM_OUT_5, PWM_OUT_7, PWM_OUT_6 }; // R, G, B
+
+uint32_t led_alarm_level = 0;    // 0 = no alarm
+volatile bool led_alarm = false;
+volatile uint32_t led_period;    // PWM counts per period (depends on the clock)
+uint32_t m_led_samples = 0;      // Samples taken (written by the ISR only)
+
+extern uint32_t sys_clk_hz;
+char UART_Get();
+
+// Duty (per mille) of one colour for an ADC value
+uint32_t Led_Curve(const uint16_t *p, uint32_t adc) {
+    uint32_t seg = adc >> LED_CURVE_SHIFT;
+    int32_t frac = adc & ((1 << LED_CURVE_SHIFT) - 1);
+    if (seg >= LED_CURVE_POINTS - 1) return p[LED_CURVE_POINTS - 1];
+    return p[seg] + (((int32_t)p[seg + 1] - (int32_t)p[seg]) * frac >> LED_CURVE_SHIFT);
+}
+
+// Per mille -> PWM compare value. A width of 0 or a full period is not
+// allowed by the generator, so the ends are clamped by one count.
+void Led_Set(int color, uint32_t permille) {
+    uint32_t w = led_period * permille / 1000;
+    if (w < 1) w = 1;
+    if (w > led_period - 1) w = led_period - 1;
+    PWMPulseWidthSet(PWM1_BASE, led_out[color], w);
+}
+
+// ADC0 sequencer 2 complete (LED_SAMPLE_HZ times a second)
+void Led_Adc_ISR(void) {
+    uint32_t v;
+    int c;
+
+    ADCIntClear(ADC0_BASE, 2);
+    ADCSequenceDataGet(ADC0_BASE, 2, &v);
+    m_led_samples++;
+
+    if (led_alarm_level) {
+        if (v >= led_alarm_level) led_alarm = true;
+        else if (v + LED_ALARM_HYST < led_alarm_level) led_alarm = false;
+    } else {
+        led_alarm = false;
+    }
+
+    if (led_alarm) {
+        bool on = (m_led_samples / (LED_SAMPLE_HZ / 4)) & 1;
+        Led_Set(LED_RED, on ? 1000 : 0);
+        Led_Set(LED_GREEN, 0);
+        Led_Set(LED_BLUE, 0);
+        return;
+    }
+    for (c = 0; c < 3; c++) Led_Set(c, Led_Curve(led_curve[c], v));
+}
+
+// PWM period and sample timer for the current system clock.
+// Called at init and by the clock governor after every switch.
+void Led_Retime() {
+    led_period = sys_clk_hz / 2 / LED_PWM_HZ; // PWM clock = system clock / 2
+    PWMGenPeriodSet(PWM1_BASE, PWM_GEN_2, led_period);
+    PWMGenPeriodSet(PWM1_BASE, PWM_GEN_3, led_period);
+    TimerLoadSet(TIMER1_BASE, TIMER_A, sys_clk_hz / LED_SAMPLE_HZ);
+}
+
+// PWM1 on PF1-PF3, Timer1 -> ADC0 sequencer 2 -> Led_Adc_ISR.
+// Port F, ADC0 and PE3 must already be enabled.
+void Led_Init() {
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_PWM1);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1);
+    SysCtlPWMClockSet(SYSCTL_PWMDIV_2); // 40000 counts per period at 80 MHz (16 bit)
+
+    GPIOPinConfigure(GPIO_PF1_M1PWM5);
+    GPIOPinConfigure(GPIO_PF2_M1PWM6);
+    GPIOPinConfigure(GPIO_PF3_M1PWM7);
+    GPIOPinTypePWM(GPIO_PORTF_BASE, GPIO_PIN_1 | GPIO_PIN_2 | GPIO_PIN_3);
+
+    PWMGenConfigure(PWM1_BASE, PWM_GEN_2, PWM_GEN_MODE_DOWN | PWM_GEN_MODE_NO_SYNC);
+    PWMGenConfigure(PWM1_BASE, PWM_GEN_3, PWM_GEN_MODE_DOWN | PWM_GEN_MODE_NO_SYNC);
+
+    TimerConfigure(TIMER1_BASE, TIMER_CFG_PERIODIC);
+    TimerControlTrigger(TIMER1_BASE, TIMER_A, true); // Timeout starts the ADC
+    Led_Retime();
+    Led_Set(LED_RED, 0); Led_Set(LED_GREEN, 0); Led_Set(LED_BLUE, 0);
+
+    PWMOutputState(PWM1_BASE, PWM_OUT_5_BIT | PWM_OUT_6_BIT | PWM_OUT_7_BIT, true);
+    PWMGenEnable(PWM1_BASE, PWM_GEN_2);
+    PWMGenEnable(PWM1_BASE, PWM_GEN_3);
+
+    // Sequencer 2, one step: PE3 (channel 0), interrupt at the end.
+    // Priority 1, below sequencer 3 (priority 0) used by the report.
+    ADCSequenceConfigure(ADC0_BASE, 2, ADC_TRIGGER_TIMER, 1);
+    ADCSequenceStepConfigure(ADC0_BASE, 2, 0, ADC_CTL_CH0 | ADC_CTL_IE | ADC_CTL_END);
+    ADCSequenceEnable(ADC0_BASE, 2);
+    ADCIntClear(ADC0_BASE, 2);
+    ADCIntRegister(ADC0_BASE, 2, Led_Adc_ISR);
+    ADCIntEnable(ADC0_BASE, 2);
+    IntEnable(INT_ADC0SS2);
+
+    TimerEnable(TIMER1_BASE, TIMER_A);
+}
+
+// Reads a decimal number up to ',' or end of line. '*end' gets the
+// character that ended it. Returns false for anything else.
+bool Led_Read_Number(uint32_t *value, char *end) {
+    uint32_t v = 0;
+    int digits = 0;
+    char c;
+    while (1) {
+        c = UART_Get();
+        if (c < '0' || c > '9') break;
+        if (++digits > 5) v = 100000; // Out of range for every field
+        else v = v * 10 + (c - '0');
+    }
+    *value = v;
+    *end = c;
+    return digits > 0 && (c == ',' || c == '\r' || c == '\n');
+}
+
+// Bad 'W' line: skips what is left of it, so the rest is never taken as
+// commands. 'last' is the last character already read.
+bool Led_Reject(char last) {
+    while (last != '\r' && last != '\n') last = UART_Get();
+    return false;
+}
+
+// 'W' command (the letter is already read)
+bool Led_Command(void) {
+    char which = UART_Get(), end = ',';
+    uint32_t v, p[LED_CURVE_POINTS];
+    int color, i;
+
+    if (which == 'A') {
+        if (!Led_Read_Number(&v, &end) || end == ',' || v > 4095) return Led_Reject(end);
+        led_alarm_level = v;
+        return true;
+    }
+
+    if (which == 'R') color = LED_RED;
+    else if (which == 'G') color = LED_GREEN;
+    else if (which == 'B') color = LED_BLUE;
+    else return Led_Reject(which);
+
+    for (i = 0; i < LED_CURVE_POINTS; i++) {
+        if (!Led_Read_Number(&v, &end) || v > 1000) return Led_Reject(end);
+        // Commas between the points, end of line after the last one
+        if ((end == ',') != (i < LED_CURVE_POINTS - 1)) return Led_Reject(end);
+        p[i] = v;
+    }
+
+    // The ISR may run between two stores; one mixed sample is harmless
+    for (i = 0; i < LED_CURVE_POINTS; i++) led_curve[color][i] = (uint16_t)p[i];
+    return true;
+}
+
+#endif
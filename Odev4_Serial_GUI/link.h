@@ -0,0 +1,147 @@
+// ============================================================================
+//                          UART LINK NEGOTIATION
+// ============================================================================
+// The link starts at 9600 8N1 (or at the last confirmed rate saved in
+// EEPROM, see Link_Resume). The PC can then move it to a faster
+// rate:
+//
+//   PC  -> "B115200\n"             (at the current rate)
+//   Dev -> "B;OK;115200;<flow>"    (at the current rate, then switches)
+//   PC  -> "P8"                    (at the NEW rate)
+//   Dev -> 8 x "P;<n>;<64 pattern chars>"
+//   PC  -> "B!\n"                  (only if every pattern line was correct)
+//   Dev -> "B;KEEP;115200"
+//
+// The new rate is only kept once "B!" arrives at it. The PC sends it after
+// checking the pattern, so a 'P' that got through while the pattern came
+// back corrupt does not commit the device. Without "B!" within
+// LINK_VERIFY_MS the device goes back to the previous rate by itself, the
+// same moment the PC gives up, so a failed step never leaves the two ends
+// talking past each other. Going back to LINK_DEFAULT_BAUD needs no
+// confirmation (it is the rate both ends fall back to anyway). 'P' also
+// works outside a negotiation as a throughput test.
+//
+// <flow> tells the PC whether RTS/CTS is in use. UART0 on the TM4C123 has
+// no modem flow control pins (only UART1 does) and the LaunchPad wires just
+// RX/TX to the ICDI bridge, so this is 0 unless the link is moved to a
+// UART with RTS/CTS wired and LINK_FLOW_CONTROL is set to 1.
+// ============================================================================
+
+#ifndef _LINK_H
+#define _LINK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define LINK_BASE          UART0_BASE
+#define LINK_DEFAULT_BAUD  9600
+#define LINK_VERIFY_MS     2000
+#ifndef LINK_FLOW_CONTROL
+#define LINK_FLOW_CONTROL  0 // 1: RTS/CTS (needs a UART with the pins wired)
+#endif
+#define LINK_PATTERN_LEN   64
+
+// Rates the PC may ask for
+const uint32_t link_rates[] = { 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600 };
+#define LINK_RATE_COUNT (sizeof(link_rates) / sizeof(link_rates[0]))
+
+uint32_t link_baud = LINK_DEFAULT_BAUD;
+uint32_t link_prev_baud = LINK_DEFAULT_BAUD;
+bool link_verifying = false;
+uint32_t link_deadline;        // ms_ticks value that ends the verify window
+
+extern volatile uint32_t ms_ticks;
+extern uint32_t sys_clk_hz;
+void UART_Print(char *str);
+char UART_Get();
+void Tx_Flush(); // uart_tx.h
+
+// Reprograms the UART. Waits for the queued frames and the last byte to
+// leave at the old rate.
+void Link_Set_Baud(uint32_t baud) {
+    Tx_Flush();
+    UARTConfigSetExpClk(LINK_BASE, sys_clk_hz, baud,
+                        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
+#if LINK_FLOW_CONTROL
+    UARTFlowControlSet(LINK_BASE, UART_FLOWCONTROL_TX | UART_FLOWCONTROL_RX);
+#endif
+    link_baud = baud;
+}
+
+// "B!": the PC checked the pattern at the new rate, keep it
+bool Link_Confirm(char *buf) {
+    link_verifying = false;
+    sprintf(buf, "B;KEEP;%u\r\n", link_baud);
+    UART_Print(buf);
+    return true;
+}
+
+// 'B' command (the letter is already read). Returns false for a bad rate.
+bool Link_Command_Rate(char *buf) {
+    uint32_t rate = 0, i, n = 0;
+    bool keep = false, bad = false;
+    char c;
+    // The whole line is read even after a bad character, so the rest of
+    // it is never taken as commands
+    while (1) {
+        c = UART_Get();
+        if (c == '\r' || c == '\n') break;
+        if (n++ == 0 && c == '!') keep = true;
+        else if (!keep && c >= '0' && c <= '9' && rate <= 100000000) rate = rate * 10 + (c - '0');
+        else bad = true;
+    }
+    if (keep) return !bad && Link_Confirm(buf);
+    if (bad) rate = 0;
+
+    for (i = 0; i < LINK_RATE_COUNT; i++) {
+        if (link_rates[i] == rate) {
+            sprintf(buf, "B;OK;%u;%d\r\n", rate, LINK_FLOW_CONTROL);
+            UART_Print(buf);
+            link_prev_baud = link_baud;
+            Link_Set_Baud(rate);
+            link_verifying = (rate != LINK_DEFAULT_BAUD);
+            link_deadline = ms_ticks + LINK_VERIFY_MS;
+            return true;
+        }
+    }
+    sprintf(buf, "B;NO;%u\r\n", link_baud);
+    UART_Print(buf);
+    return false;
+}
+
+// 'P' command: the next char is the line count ('1'..'9').
+// Does not confirm a new rate; the PC checks the lines first, then sends "B!".
+bool Link_Command_Pattern(char *buf) {
+    char n = UART_Get();
+    int line, i;
+    if (n < '1' || n > '9') return false;
+
+    for (line = 0; line < n - '0'; line++) {
+        char *p = buf + sprintf(buf, "P;%d;", line);
+        for (i = 0; i < LINK_PATTERN_LEN; i++) *p++ = '!' + (char)((i * 7 + line) % 94);
+        sprintf(p, "\r\n");
+        UART_Print(buf);
+    }
+    return true;
+}
+
+// Boot with a rate saved in EEPROM (persist.h). Same safety net as 'B':
+// kept only if the PC confirms it with "B!", otherwise back to the default.
+void Link_Resume(uint32_t baud) {
+    if (baud == link_baud) return;
+    link_prev_baud = LINK_DEFAULT_BAUD;
+    Link_Set_Baud(baud);
+    link_verifying = true;
+    link_deadline = ms_ticks + LINK_VERIFY_MS;
+}
+
+// Call every main loop pass: falls back if the PC never confirmed
+void Link_Poll() {
+    if (link_verifying && (int32_t)(ms_ticks - link_deadline) >= 0) {
+        link_verifying = false;
+        Link_Set_Baud(link_prev_baud);
+    }
+}
+
+#endif
@@ -5,12 +5,14 @@
 #include <stdbool.h> // Boolean (true/false)
 #include <stdlib.h>  // Standard Library (used for 'atoi' string conversion)
 #include <stdio.h>   // Standard I/O (used for 'sprintf' text formatting)
+#include <string.h>  // String helpers (used for 'strlen')
 
 // Hardware definition files (Addresses of registers)
 #include "inc/hw_ints.h"
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
 #include "inc/hw_gpio.h" // Needed for direct register access (HWREG)
+#include "inc/hw_uart.h" // RX error bits (UART_DR_OE, UART_DR_FE)
 
 // Driver libraries (Functions to control peripherals)
 #include "driverlib/gpio.h"
@@ -20,19 +22,47 @@
 #include "driverlib/timer.h"    // Hardware Timers
 #include "driverlib/interrupt.h"
 #include "driverlib/adc.h"      // Analog to Digital Converter
+#include "driverlib/systick.h"  // 1 ms system tick
+
+// LCD driver (Port B, 4-bit mode) + custom glyph cache
+#include "lcd.h"
+#include "lcd_glyph.h"
+
+// Event trace ring (TRACE macro, 'T' dump command)
+#include "trace.h"
+
+// Runtime counters ('D' command)
+#include "metrics.h"
+
+// UART0 transmit queue sent by uDMA (every outgoing line)
+#include "uart_tx.h"
+
+// Baud rate negotiation ('B' and 'P' commands)
+#include "link.h"
+
+// RGB LED driven by the ADC through PWM ('W' command)
+#include "led_pwm.h"
+
+// Workload-driven clock scaling ('G' command)
+#include "governor.h"
+
+// ADC -> engineering units through integer lookup tables ('K' command)
+#include "calib.h"
+
+// Settings and clock checkpoint kept in EEPROM ('E' command)
+#include "persist.h"
 
 // ============================================================================
-//                             HARDWARE MAPPING
+//                             SETTINGS
 // ============================================================================
-// LCD Connections: Using Port B
-#define LCD_PORT_BASE GPIO_PORTB_BASE
-#define RS GPIO_PIN_0 // Register Select
-#define E  GPIO_PIN_1 // Enable
-// Data Pins (4-bit mode)
-#define D4 GPIO_PIN_4
-#define D5 GPIO_PIN_5
-#define D6 GPIO_PIN_6
-#define D7 GPIO_PIN_7
+#define MSG_MAX   80  // Longest message the device keeps (characters, = PERSIST_MSG_CHARS)
+#define MSG_GAP   4   // Blank columns between the end of a message and its repeat
+#define SCROLL_MS 300 // Marquee step period (milliseconds)
+
+// LCD views (selected by the 'V' command)
+#define VIEW_TEXT      0 // Time + ADC, scrolling message
+#define VIEW_BIG_CLOCK 1 // HH:MM in 2-row digits, seconds small
+#define VIEW_BAR       2 // ADC value + horizontal bar graph
 
 // ============================================================================
 //                             GLOBAL VARIABLES
@@ -42,80 +72,227 @@ volatile int hours = 0, minutes = 0, seconds = 0;
 volatile uint32_t adcValue[1]; // Array to store ADC result
 
 // Default message to show on LCD until changed by PC
-char lcd_custom_msg[8] = "---";
+char lcd_custom_msg[MSG_MAX + 1] = "---";
+
+// Millisecond counter (SysTick) and the marquee "step now" flag
+volatile uint32_t ms_ticks = 0;
+volatile bool scroll_flag = false;
+
+// System clock (Hz). Read after SysCtlClockSet, changed by the governor
+uint32_t sys_clk_hz;
+
+// Boot timing: microseconds from tick start to the first UART report
+bool first_report_sent = false;
 
 // Flag: Timer sets this to TRUE every second. Main loop reads it.
 volatile bool send_report_flag = false;
 
+// Latency mode ('L1'): reports carry device timestamps (Micros) of the
+// timer tick, the ADC conversion and the start of transmission.
+// 'Q' returns the current Micros() so the PC can map them to its own clock.
+bool latency_mode = false;
+volatile uint32_t tick_us = 0; // Set by Timer0IntHandler
+
 // Flag: Fixes the issue where fast button presses are missed.
 // If we press the button at 0.5s, the main loop remembers it until the 1.0s report.
 bool button_latch = false;
+bool button_was_down = false; // Previous poll, to count presses (edges)
 
 // Text buffers for formatting strings
 char l1[64];    // Line 1 buffer
-char l2[64];    // Line 2 buffer
+char unitBuf[16]; // Calibrated ADC value with its unit ("1650mV")
 char txBuf[64]; // Transmit (UART) buffer
+char diagBuf[256]; // Command replies: 'K?' line (~200), 'P' pattern lines (~72)
+
+// Marquee state (see LCD MARQUEE below)
+int msg_len = 3;        // strlen(lcd_custom_msg)
+int marquee_len = 16;   // Length of the scrolling stream (message + gap)
+int marquee_pos = 0;    // Stream index shown at the left edge of the screen
+uint8_t lcd_shift = 0;  // DDRAM column currently at the left edge of the screen
+bool marquee_on = false;
+
+// Current LCD view and the big-clock digits already on screen
+int lcd_view = VIEW_TEXT;
+int big_drawn[4] = { -1, -1, -1, -1 };
 
 // ============================================================================
-//                             LCD DRIVER
+//                             LCD MARQUEE
 // ============================================================================
-// Toggles the Enable pin to latch data
-void LCD_Pulse_Enable() {
-    GPIOPinWrite(LCD_PORT_BASE, E, E); // High
-    SysCtlDelay(40000);                // Wait
-    GPIOPinWrite(LCD_PORT_BASE, E, 0); // Low
-    SysCtlDelay(40000);                // Wait
+// Line 2 shows the PC message. Messages that fit in 16 columns are static.
+// Longer ones scroll using the LCD's own display shift:
+//   - up to 36 chars: the whole stream sits in the 40-column DDRAM ring,
+//     so a step is ONE command (shift).
+//   - longer: before the hidden column is needed again we write the next
+//     stream character into it, so a step is shift + goto + 1 char,
+//     no matter how long the message is.
+// The shift moves BOTH lines, so line 1 is always drawn at 'lcd_shift'
+// (the current window) when the report refreshes it.
+
+// Returns character 'i' of the endless stream "message + gap + message + ..."
+char Marquee_Char(int i) {
+    i %= marquee_len;
+    return (i < msg_len) ? lcd_custom_msg[i] : ' ';
+}
+
+// Writes a new message into DDRAM and resets the window
+void Marquee_Load() {
+    int i, n;
+
+    LCD_Frame_Begin(true);
+    msg_len = strlen(lcd_custom_msg);
+    marquee_on = (msg_len > LCD_COLS);
+    marquee_len = msg_len + MSG_GAP;
+    if (marquee_len < LCD_DDRAM_COLS) marquee_len = LCD_DDRAM_COLS;
+
+    LCD_Home(); // Window back to column 0
+    lcd_shift = 0;
+    marquee_pos = 0;
+
+    // Static text only needs the visible 16 columns, scrolling text fills the ring
+    n = marquee_on ? LCD_DDRAM_COLS : LCD_COLS;
+    LCD_Goto(1, 0);
+    for (i = 0; i < n; i++) LCD_Data(Marquee_Char(i));
+    LCD_Frame_End();
+}
+
+// Advances the marquee by one column
+void Marquee_Step() {
+    if (!marquee_on) return;
+
+    LCD_Frame_Begin(true); // Every step must reach the LCD
+    LCD_Shift_Left();
+
+    // Column 'lcd_shift' just left the screen. It is now the hidden column
+    // furthest to the right, so refill it with the character 40 ahead.
+    if (marquee_len > LCD_DDRAM_COLS) {
+        LCD_Goto(1, lcd_shift);
+        LCD_Data(Marquee_Char(marquee_pos + LCD_DDRAM_COLS));
+    }
+
+    lcd_shift = (lcd_shift + 1) % LCD_DDRAM_COLS;
+    marquee_pos = (marquee_pos + 1) % marquee_len;
+    LCD_Frame_End();
 }
 
-// Sends 4 bits to the LCD data pins
-void LCD_Write_4Bit(unsigned char data) {
-    // Write data to pins 4-7.
-    // (data << 4) shifts the value to match the pin positions (PB4-PB7).
-    GPIOPinWrite(LCD_PORT_BASE, D4|D5|D6|D7, (data << 4));
-    LCD_Pulse_Enable();
+// ============================================================================
+//                             LCD VIEWS
+// ============================================================================
+// Clears the screen and prepares the static parts of a view
+void View_Select(int view) {
+    int i;
+
+    lcd_view = view;
+    LCD_Frame_Begin(true);
+    LCD_Cmd(LCD_CMD_CLEAR); // LCD_Frame_Poll waits the ~1.5ms it needs
+    for (i = 0; i < 4; i++) big_drawn[i] = -1;
+
+    if (view == VIEW_TEXT) {
+        Marquee_Load(); // Also resets the window
+        LCD_Frame_End();
+        return;
+    }
+
+    // Other views do not scroll
+    LCD_Home();
+    lcd_shift = 0;
+    marquee_on = false;
+
+    if (view == VIEW_BIG_CLOCK) {
+        // Colon between HH and MM (ROM character 0xA5 is a centered dot)
+        LCD_Goto(0, 6); LCD_Data(0xA5);
+        LCD_Goto(1, 6); LCD_Data(0xA5);
+    }
+    LCD_Frame_End();
 }
 
-// Sends a Command (RS = 0)
-void LCD_Cmd(unsigned char cmd) {
-    GPIOPinWrite(LCD_PORT_BASE, RS, 0); // RS Low = Command
-    LCD_Write_4Bit(cmd >> 4);           // Send Upper Nibble
-    LCD_Write_4Bit(cmd & 0x0F);         // Send Lower Nibble
-    SysCtlDelay(80000);                 // Wait for command to process
+// Renders the current view into the back frame (called once per report).
+// Dropped when the display has not finished the previous frame yet.
+void View_Draw() {
+    if (!lcd_ready) return; // Still powering up
+    if (!LCD_Frame_Begin(false)) return;
+    TRACE(TR_LCD_BEGIN, lcd_view);
+    if (lcd_view == VIEW_BIG_CLOCK) {
+        const uint8_t col[4] = { 0, 3, 7, 10 };
+        int d[4], i;
+        d[0] = hours / 10;   d[1] = hours % 10;
+        d[2] = minutes / 10; d[3] = minutes % 10;
+
+        // Unchanged digits first, so their glyphs are pinned before a
+        // changed digit may need to evict something
+        Glyph_Frame_Begin();
+        for (i = 0; i < 4; i++)
+            if (d[i] == big_drawn[i]) Big_Digit_Draw(col[i], d[i], false);
+        for (i = 0; i < 4; i++)
+            if (d[i] != big_drawn[i]) Big_Digit_Draw(col[i], d[i], true);
+        for (i = 0; i < 4; i++) big_drawn[i] = d[i];
+        sprintf(l1, "%02d", seconds);
+        LCD_Goto(1, 14);
+        LCD_Print(l1);
+    }
+    else if (lcd_view == VIEW_BAR) {
+        Cal_Format(unitBuf, 0, Cal_Convert(0, adcValue[0]));
+        sprintf(l1, "%-11.11s %3u%%", unitBuf, (adcValue[0] * 100) / 4095);
+        LCD_Goto(0, 0);
+        LCD_Print(l1);
+
+        Glyph_Frame_Begin();
+        Bar_Graph_Draw(1, adcValue[0], 4095);
+    }
+    else {
+        // Line 1: Time + ADC value, drawn inside the current window.
+        // (Line 2 holds the message and is only written by the marquee.)
+        // A '?' after the time: restored from EEPROM, not confirmed by the PC yet
+        Cal_Format(unitBuf, 0, Cal_Convert(0, adcValue[0]));
+        sprintf(l1, "%02d:%02d:%02d%c%7.7s", hours, minutes, seconds, time_synced ? ' ' : '?', unitBuf);
+        LCD_Write_Ring(0, lcd_shift, l1, LCD_COLS);
+    }
+    TRACE(TR_LCD_END, lcd_view);
+    LCD_Frame_End();
 }
 
-// Sends Data/Characters (RS = 1)
-void LCD_Data(unsigned char data) {
-    GPIOPinWrite(LCD_PORT_BASE, RS, RS); // RS High = Data
-    LCD_Write_4Bit(data >> 4);           // Send Upper Nibble
-    LCD_Write_4Bit(data & 0x0F);         // Send Lower Nibble
-    SysCtlDelay(80000);                  // Wait
+// Status page on the extra displays (LCD_DISPLAYS > 1), one line per row.
+// ROM characters only: the glyph cache belongs to display 0's CGRAM.
+void Status_Draw() {
+#if LCD_DISPLAYS > 1
+    int d;
+    if (!lcd_ready) return;
+    for (d = 1; d < LCD_DISPLAYS; d++) {
+        LCD_Select(d);
+        if (!LCD_Frame_Begin(false)) continue; // Still showing the last one
+        sprintf(l1, "Time %02d:%02d:%02d%c", hours, minutes, seconds, time_synced ? ' ' : '?');
+        LCD_Print_Line(0, l1);
+        Cal_Format(unitBuf, 0, Cal_Convert(0, adcValue[0]));
+        sprintf(l1, "In %-8.8s %3u%%", unitBuf, (adcValue[0] * 100) / 4095);
+        LCD_Print_Line(1, l1);
+        if (lcd_cur->rows > 2) {
+            sprintf(l1, "%2u MHz %6u bd", sys_clk_hz / 1000000, link_baud);
+            LCD_Print_Line(2, l1);
+            LCD_Print_Line(3, lcd_custom_msg);
+        }
+        LCD_Frame_End();
+    }
+    LCD_Select(0);
+#endif
 }
 
-// Initializes the LCD
-void LCD_Init() {
-    // Enable Port B
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
-    // Set pins as Output
-    GPIOPinTypeGPIOOutput(LCD_PORT_BASE, 0xFF);
-    SysCtlDelay(1000000); // Wait for power up
-
-    // "Magic" sequence to force 4-bit mode
-    LCD_Write_4Bit(0x03); SysCtlDelay(100000);
-    LCD_Write_4Bit(0x03); SysCtlDelay(100000);
-    LCD_Write_4Bit(0x03); SysCtlDelay(100000);
-    LCD_Write_4Bit(0x02); // 4-bit mode set
-
-    // Configure Display
-    LCD_Cmd(0x28); // 4-bit, 2 lines
-    LCD_Cmd(0x0C); // Display ON
-    LCD_Cmd(0x06); // Cursor Auto-Increment
-    LCD_Cmd(0x01); // Clear Screen
-    SysCtlDelay(200000);
+// ============================================================================
+//                             SYSTICK INTERRUPT
+// ============================================================================
+// Runs every 1 ms
+void SysTickIntHandler(void) {
+    ms_ticks++;
+    if ((ms_ticks % SCROLL_MS) == 0) scroll_flag = true;
 }
 
-// Prints a full string
-void LCD_Print(char *str) {
-    while(*str) LCD_Data(*str++);
+// Microseconds since SysTick started (wraps after ~71 minutes)
+uint32_t Micros() {
+    uint32_t ms, left;
+    // Re-read if the tick interrupt ran in between
+    do {
+        ms = ms_ticks;
+        left = SysTickValueGet(); // Counts DOWN from period-1
+    } while (ms != ms_ticks);
+    return ms * 1000 + ((sys_clk_hz / 1000 - 1 - left) / (sys_clk_hz / 1000000));
 }
 
 // ============================================================================
@@ -125,6 +302,9 @@ void LCD_Print(char *str) {
 void Timer0IntHandler(void) {
     // Clear the interrupt flag
     TimerIntClear(TIMER0_BASE, TIMER_TIMA_TIMEOUT);
+    TRACE(TR_TIMER0, seconds);
+    tick_us = Micros();
+    Gov_Timer_Tick(); // Full period again after a clock switch
 
     // Increment Time
     if(++seconds >= 60) {
@@ -138,35 +318,78 @@ void Timer0IntHandler(void) {
     send_report_flag = true;
 }
 
+// ============================================================================
+//                             UART HELPERS
+// ============================================================================
+// Queues a string for the uDMA (uart_tx.h); waits only if the queue is full
+void UART_Print(char *str) {
+    Tx_Send(str);
+}
+
+// Waits for one received byte. The data register also carries the error
+// flags of that byte (bits 8-11), which feed the RX error counters.
+char UART_Get() {
+    int32_t c;
+    if (!UARTCharsAvail(UART0_BASE)) { // Byte still on the wire: not load
+        uint32_t w = Metrics_Wait_Begin();
+        while(!UARTCharsAvail(UART0_BASE));
+        Metrics_Wait_End(w);
+    }
+    c = UARTCharGet(UART0_BASE);
+    if (c & UART_DR_OE) m_uart_overrun++;
+    if (c & UART_DR_FE) m_uart_framing++;
+    return (char)c;
+}
+
 // ============================================================================
 //                             HARDWARE SETUP
 // ============================================================================
 void InitHardware() {
-    // 1. Clock Setup (Set to 16MHz)
-    SysCtlClockSet(SYSCTL_SYSDIV_2_5 | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN | SYSCTL_XTAL_16MHZ);
-
-    // 2. UART Setup (PC Communication)
+    // 1. Clock Setup (Start at 80MHz; the governor lowers it when idle)
+    SysCtlClockSet(gov_levels[GOV_TOP].config);
+    sys_clk_hz = SysCtlClockGet();
+    Trace_Init(); // Cycle counter for trace timestamps
+    Metrics_Init(sys_clk_hz);
+
+    // 2. SysTick: 1 ms tick (init deadlines, marquee, boot timing)
+    SysTickPeriodSet(sys_clk_hz / 1000);
+    SysTickIntRegister(SysTickIntHandler);
+    SysTickIntEnable();
+    SysTickEnable();
+
+    // 3. LCD: only start the power-up window here. The wake-up sequence is
+    //    finished later by LCD_Init_Poll() in the main loop, so the setup
+    //    below runs while the LCD is still powering up.
+    LCD_Init_Start(ms_ticks);
+
+    // 4. UART Setup (PC Communication)
     SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0); // Enable UART Module
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA); // Enable Port A (Rx/Tx pins)
     GPIOPinConfigure(GPIO_PA0_U0RX);             // Set Pin A0 as RX
     GPIOPinConfigure(GPIO_PA1_U0TX);             // Set Pin A1 as TX
     GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1); // Activate UART mode
 
-    // Configure UART: 9600 Baud Rate, 8 data bits, 1 stop bit, No parity
-    UARTConfigSetExpClk(UART0_BASE, SysCtlClockGet(), 9600, (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
+    // Configure UART: 9600 Baud Rate, 8 data bits, 1 stop bit, No parity.
+    // The PC may raise the rate later with the 'B' command (link.h).
+    Link_Set_Baud(LINK_DEFAULT_BAUD);
+    Tx_Init(); // uDMA channel 9 feeds the TX FIFO from now on
 
-    // 3. Timer Setup
+    // 5. Timer Setup
     SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
     TimerConfigure(TIMER0_BASE, TIMER_CFG_PERIODIC); // Repeat mode
-    TimerLoadSet(TIMER0_BASE, TIMER_A, SysCtlClockGet()); // Load 1 second worth of ticks
+    TimerLoadSet(TIMER0_BASE, TIMER_A, sys_clk_hz); // Load 1 second worth of ticks
     TimerIntRegister(TIMER0_BASE, TIMER_A, Timer0IntHandler); // Link ISR function
     IntEnable(INT_TIMER0A); // Enable in NVIC
     TimerIntEnable(TIMER0_BASE, TIMER_TIMA_TIMEOUT); // Enable Timer Timeout Interrupt
 
-    // 4. ADC Setup (Analog Input)
+    // 6. ADC Setup (Analog Input)
     SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOE); // Using Port E
 
+    // Clock the ADC from PIOSC (16 MHz) so it keeps working when the
+    // governor turns the PLL off
+    ADCClockConfigSet(ADC0_BASE, ADC_CLOCK_SRC_PIOSC | ADC_CLOCK_RATE_FULL, 1);
+
     // Set Pin PE3 as Analog Input
     GPIOPinTypeADC(GPIO_PORTE_BASE, GPIO_PIN_3);
 
@@ -177,7 +400,7 @@ void InitHardware() {
     ADCSequenceEnable(ADC0_BASE, 3);
     ADCIntClear(ADC0_BASE, 3);
 
-    // 5. Button Setup (PF4)
+    // 7. Button Setup (PF4)
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
 
     // Unlock Port F (Required for PF0, good practice for Port F generally)
@@ -190,7 +413,16 @@ void InitHardware() {
     GPIOPinTypeGPIOInput(GPIO_PORTF_BASE, GPIO_PIN_4);
     GPIOPadConfigSet(GPIO_PORTF_BASE, GPIO_PIN_4, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);
 
-    // 6. Start Everything
+    // 8. RGB LED (PF1-PF3): PWM duty follows the ADC, updated in the ADC
+    //    interrupt at LED_SAMPLE_HZ without the main loop
+    Led_Init();
+
+    // 9. Saved settings and the last clock checkpoint (EEPROM). Overrides
+    //    the defaults above, including the baud rate (kept only if the PC
+    //    confirms it, see Link_Resume).
+    Persist_Init(ms_ticks);
+
+    // 10. Start Everything
     IntMasterEnable(); // Enable global interrupts
     TimerEnable(TIMER0_BASE, TIMER_A); // Start the clock
 }
@@ -199,12 +431,25 @@ void InitHardware() {
 //                                MAIN LOOP
 // ============================================================================
 int main(void) {
-    InitHardware(); // Run setup
-    LCD_Init();     // Run LCD setup
+    InitHardware(); // Run setup (LCD keeps powering up in the background)
 
     adcValue[0] = 0; // Reset ADC value
 
+    // Send the first report right away instead of waiting for the first second
+    send_report_flag = true;
+
     while (1) {
+        uint32_t pass_us = Metrics_Loop(); // Loop rate + longest pass
+        Link_Poll();                       // Undo a baud change the PC never confirmed
+        Gov_Poll(pass_us - metrics_pass_wait_us, ms_ticks); // Clock level for the compute load
+        Persist_Poll(ms_ticks);            // At most one EEPROM word per pass
+        LCD_Frame_Poll(Micros());          // At most one byte per LCD per pass
+
+        // --- PHASE -1: LCD START-UP ---
+        // One step of the LCD wake-up sequence whenever its wait has passed.
+        // When it finishes, draw the current view for the first time.
+        if (!lcd_ready && LCD_Init_Poll(ms_ticks)) View_Select(lcd_view);
+
         // --- PHASE 0: CONTINUOUS POLLING (Button) ---
         // We check this constantly (thousands of times per second).
         // If the button (PF4) reads 0 (Pressed)...
@@ -213,37 +458,113 @@ int main(void) {
             // Even if you release the button immediately, this stays true
             // until the Timer Interrupt handles it later.
             button_latch = true;
+            if (!button_was_down) m_button_events++;
+            button_was_down = true;
+        } else {
+            button_was_down = false;
         }
 
         // --- PHASE 1: RECEIVE COMMANDS (UART) ---
         // Check if PC sent any data
         if (UARTCharsAvail(UART0_BASE)) {
-            char cmd = UARTCharGet(UART0_BASE); // Read first letter
+            char cmd = UART_Get(); // Read first letter
+            bool ok = true;        // Counted in the metrics below
+            TRACE(TR_CMD_RX, cmd);
 
             // Command 'S': Set Time (Format: S12:30:45)
             if (cmd == 'S') {
                 char b[9]; int i;
                 // Read the next 8 characters (12:30:45)
-                for(i=0; i<8; i++) {
-                    while(!UARTCharsAvail(UART0_BASE)); // Wait for char
-                    b[i] = UARTCharGet(UART0_BASE);
-                }
+                for(i=0; i<8; i++) b[i] = UART_Get();
                 b[8] = '\0'; // Null terminate string
 
                 // Parse string to integers.
                 // atoi(b) reads "12"
                 // atoi(b+3) skips 3 chars and reads "30"
-                hours = atoi(b); minutes = atoi(b + 3); seconds = atoi(b + 6);
+                if (b[2] == ':' && b[5] == ':') {
+                    hours = atoi(b); minutes = atoi(b + 3); seconds = atoi(b + 6);
+                    Persist_Time_Set(); // Synced, checkpoint right away
+                } else {
+                    ok = false;
+                }
             }
-            // Command 'M': Set Message (Format: MABC)
+            // Command 'M': Set Message (Format: MHello World\n)
+            // Text runs until '\r' or '\n'. Anything past MSG_MAX is dropped.
             else if (cmd == 'M') {
-                int i;
-                // Read next 3 characters
-                for(i=0; i<3; i++) {
-                    while(!UARTCharsAvail(UART0_BASE));
-                    lcd_custom_msg[i] = UARTCharGet(UART0_BASE);
+                int i = 0; char c;
+                while (1) {
+                    c = UART_Get();
+                    if (c == '\r' || c == '\n') break;
+                    if (i < MSG_MAX) lcd_custom_msg[i++] = c;
+                }
+                lcd_custom_msg[i] = '\0'; // Terminate string
+                if (lcd_ready && lcd_view == VIEW_TEXT) Marquee_Load();
+            }
+            // Command 'V': Select LCD view (Format: V0 / V1 / V2)
+            else if (cmd == 'V') {
+                char v = UART_Get();
+                if (v >= '0' && v <= '2') {
+                    if (lcd_ready) View_Select(v - '0');
+                    else lcd_view = v - '0'; // Drawn when the LCD is ready
+                } else {
+                    ok = false;
+                }
+            }
+            // Command 'L': Latency stamps on/off (Format: L1 / L0)
+            else if (cmd == 'L') {
+                char v = UART_Get();
+                if (v == '0' || v == '1') latency_mode = (v == '1');
+                else ok = false;
+            }
+            // Command 'Q': Clock query, answered at once (Format: Q;<micros>)
+            else if (cmd == 'Q') {
+                sprintf(txBuf, "Q;%u\r\n", Micros());
+                UART_Print(txBuf);
+            }
+            // Command 'B': Change baud rate (Format: B115200\n), confirm it (B!\n), see link.h
+            else if (cmd == 'B') {
+                ok = Link_Command_Rate(diagBuf);
+            }
+            // Command 'P': Test pattern (Format: P1..P9)
+            else if (cmd == 'P') {
+                ok = Link_Command_Pattern(diagBuf);
+            }
+            // Command 'G': Clock governor (Format: GA = auto, G0..G2 = fixed level)
+            else if (cmd == 'G') {
+                ok = Gov_Command();
+            }
+            // Command 'W': LED curves / alarm (Format: WR0,0,500,1000,1000\n / WA3500\n)
+            else if (cmd == 'W') {
+                ok = Led_Command();
+            }
+            // Command 'K': ADC calibration (Format: K0T100,80,4000,3220\n / K0U3,V\n / K?)
+            else if (cmd == 'K') {
+                ok = Cal_Command(diagBuf);
+            }
+            // Command 'E': EEPROM (Format: ES = save now / EI = info)
+            else if (cmd == 'E') {
+                ok = Persist_Command(txBuf);
+            }
+            // Command 'T': Dump the trace ring (one line per loop, see PHASE 4)
+            else if (cmd == 'T') {
+                if (!trace_dumping) {
+                    Trace_Dump_Start(txBuf, sys_clk_hz);
+                    UART_Print(txBuf);
                 }
-                lcd_custom_msg[3] = '\0'; // Terminate string
+            }
+            // Command 'D': Diagnostics (all metrics in one line)
+            else if (cmd == 'D') {
+                char *frame = Tx_Reserve(); // Formatted straight into the queue
+                Tx_Commit(Metrics_Format(frame, TX_SLOT_BYTES));
+            }
+            // Line endings between commands are not errors
+            else if (cmd != '\r' && cmd != '\n') {
+                ok = false;
+            }
+
+            if (cmd != '\r' && cmd != '\n') {
+                if (ok) m_cmds_ok++;
+                else    m_cmds_rejected++;
             }
         }
 
@@ -251,12 +572,20 @@ int main(void) {
         // This block runs ONLY when the Timer says so (Once per second)
         if (send_report_flag) {
             send_report_flag = false; // Reset flag
+            Metrics_Second();
+            uint32_t rpt_start = HWREG(DWT_CYCCNT); // Report path latency start
 
             // 1. Read ADC Hardware
+            TRACE(TR_ADC_BEGIN, 0);
             ADCProcessorTrigger(ADC0_BASE, 3); // Trigger
+            uint32_t adc_wait = Metrics_Wait_Begin();
             while(!ADCIntStatus(ADC0_BASE, 3, false)); // Wait
+            Metrics_Wait_End(adc_wait);
             ADCIntClear(ADC0_BASE, 3); // Clear flag
             ADCSequenceDataGet(ADC0_BASE, 3, (uint32_t*)adcValue); // Get Data
+            TRACE(TR_ADC_END, adcValue[0]);
+            uint32_t conv_us = Micros();
+            m_adc_count++;
 
             // 2. Button State Logic
             // If button_latch is true, set btn=1, otherwise btn=0.
@@ -264,20 +593,44 @@ int main(void) {
             button_latch = false; // Reset latch for the next second
 
             // 3. Send Report to PC (Format: 12:00:00;1024;1)
-            sprintf(txBuf, "%02d:%02d:%02d;%u;%d\r\n", hours, minutes, seconds, adcValue[0], btn);
-            // Loop through string and send char by char via UART
-            char *p = txBuf; while(*p) UARTCharPut(UART0_BASE, *p++);
-
-            // 4. Update LCD Screen
-            // Line 1: Time
-            sprintf(l1, "Time: %02d:%02d:%02d", hours, minutes, seconds);
-            LCD_Cmd(0x80); // Move cursor to Line 1
-            LCD_Print(l1);
-
-            // Line 2: ADC value + Custom Message
-            sprintf(l2, "ADC:%4u Msg:%s", adcValue[0], lcd_custom_msg);
-            LCD_Cmd(0xC0); // Move cursor to Line 2
-            LCD_Print(l2);
+            //    Latency mode appends ;tick;conv;tx (Micros, tx = queued)
+            //    Written straight into a transmit slot, the uDMA sends it
+            char *rpt = Tx_Reserve();
+            int n = sprintf(rpt, "%02d:%02d:%02d;%u;%d", hours, minutes, seconds, adcValue[0], btn);
+            if (latency_mode) n += sprintf(rpt + n, ";%u;%u;%u", tick_us, conv_us, Micros());
+            n += sprintf(rpt + n, "\r\n");
+            TRACE(TR_UART_BEGIN, n);
+            Tx_Commit(n);
+            TRACE(TR_UART_END, 0);
+            Metrics_Report_Latency(HWREG(DWT_CYCCNT) - rpt_start);
+
+            // First report after reset: tell the PC how long it took and what
+            // came back from EEPROM (BOOT;<us>;<settings>;<clock>)
+            if (!first_report_sent) {
+                first_report_sent = true;
+                m_boot_us = Micros();
+                sprintf(txBuf, "BOOT;%u;%d;%d\r\n", m_boot_us, persist_cfg_restored, persist_clk_restored);
+                UART_Print(txBuf);
+            }
+
+            // 4. Update LCD Screen (only rendered here, LCD_Frame_Poll sends it)
+            View_Draw();
+            Status_Draw();
+        }
+
+        // --- PHASE 3: MARQUEE ---
+        // One column per SCROLL_MS (one LCD command per step)
+        if (scroll_flag) {
+            scroll_flag = false;
+            TRACE(TR_SCROLL_BEGIN, lcd_shift);
+            Marquee_Step();
+            TRACE(TR_SCROLL_END, lcd_shift);
+        }
+
+        // --- PHASE 4: TRACE DUMP ---
+        // One record per pass, only when no report is waiting
+        if (trace_dumping && !send_report_flag) {
+            if (Trace_Dump_Line(txBuf)) UART_Print(txBuf);
         }
     }
 }
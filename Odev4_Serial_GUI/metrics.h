@@ -0,0 +1,190 @@
+// ============================================================================
+//                          RUNTIME METRICS REGISTRY
+// ============================================================================
+// Plain uint32_t counters in RAM. Updating one is a single increment, so they
+// stay on all the time. All of them are written from the main loop, except
+// 'led' which only the LED ADC interrupt writes (one writer, one 32-bit
+// store), so no locking is needed.
+//
+// The 'D' command sends every registered metric in ONE line:
+//     D;lps=41230;lmax=18250;ovr=0;fe=0;cmd=12;rej=1;...;rh=0,0,0,0,57,3,0,0
+// Names are kept short (at most METRIC_NAME_MAX characters) because the
+// frame travels at 9600 baud.
+// ============================================================================
+
+#ifndef _METRICS_H
+#define _METRICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "trace.h" // DWT cycle counter
+
+// ============================================================================
+//                             COUNTERS
+// ============================================================================
+uint32_t m_loop_count = 0;    // Loop passes in the current second
+uint32_t m_loops_per_sec = 0; // Loop passes in the last full second
+uint32_t m_loop_max_us = 0;   // Longest single pass since the last 'D'
+uint32_t m_uart_overrun = 0;  // RX bytes flagged with overrun (OE)
+uint32_t m_uart_framing = 0;  // RX bytes flagged with framing error (FE)
+uint32_t m_cmds_ok = 0;       // Commands understood
+uint32_t m_cmds_rejected = 0; // Unknown letters / bad arguments
+uint32_t m_adc_count = 0;     // ADC conversions
+uint32_t m_button_events = 0; // Button presses (falling edges)
+uint32_t m_boot_us = 0;       // Tick start -> first report
+
+// Report path latency (ADC trigger -> report queued for the uDMA) histogram.
+// Bucket k counts latencies below 1024 << k us (~1, 2, 4 ... 64 ms),
+// the last bucket counts everything slower.
+#define RPT_HIST_BUCKETS 8
+uint32_t m_rpt_hist[RPT_HIST_BUCKETS];
+
+// ============================================================================
+//                             REGISTRY
+// ============================================================================
+typedef struct {
+    const char *name;
+    uint32_t *value;
+} metric_t;
+
+extern uint32_t lcd_bytes;     // lcd.h
+extern uint32_t lcd_frames_shown;
+extern uint32_t lcd_frames_dropped;
+extern uint32_t lcd_frame_overflow;
+extern uint32_t glyph_uploads; // lcd_glyph.h
+extern uint32_t glyph_hits;
+extern uint32_t gov_level;     // governor.h
+extern uint32_t gov_util;
+extern uint32_t m_gov_ms[];
+extern uint32_t m_gov_switches;
+extern uint32_t m_gov_ma_x10;
+extern uint32_t m_led_samples; // led_pwm.h
+extern uint32_t m_ee_words;    // persist.h
+extern uint32_t m_ee_saves;
+extern uint32_t m_ee_ckpts;
+extern uint32_t m_tx_frames;   // uart_tx.h
+extern uint32_t m_tx_idle_ms;
+extern uint32_t m_tx_gaps;
+extern uint32_t m_tx_waits;
+
+const metric_t metric_table[] = {
+    { "lps",  &m_loops_per_sec },
+    { "lmax", &m_loop_max_us },
+    { "ovr",  &m_uart_overrun },
+    { "fe",   &m_uart_framing },
+    { "cmd",  &m_cmds_ok },
+    { "rej",  &m_cmds_rejected },
+    { "lcd",  &lcd_bytes },
+    { "lfr",  &lcd_frames_shown },
+    { "ldr",  &lcd_frames_dropped },
+    { "lov",  &lcd_frame_overflow },
+    { "adc",  &m_adc_count },
+    { "btn",  &m_button_events },
+    { "boot", &m_boot_us },
+    { "gup",  &glyph_uploads },
+    { "ghit", &glyph_hits },
+    { "gl",   &gov_level },
+    { "gu",   &gov_util },
+    { "g16",  &m_gov_ms[0] },
+    { "g40",  &m_gov_ms[1] },
+    { "g80",  &m_gov_ms[2] },
+    { "gsw",  &m_gov_switches },
+    { "gma",  &m_gov_ma_x10 },
+    { "led",  &m_led_samples },
+    { "ew",   &m_ee_words },
+    { "esv",  &m_ee_saves },
+    { "eck",  &m_ee_ckpts },
+    { "txf",  &m_tx_frames },
+    { "txi",  &m_tx_idle_ms },
+    { "txg",  &m_tx_gaps },
+    { "txw",  &m_tx_waits },
+};
+#define METRIC_COUNT (sizeof(metric_table) / sizeof(metric_table[0]))
+
+// Worst case 'D' frame, every counter at 10 digits:
+// "D" + ";name=4294967295" per metric + ";rh=" + 8 x ",4294967295" + "\r\n" + NUL
+#define METRIC_NAME_MAX    4
+#define METRIC_FRAME_BYTES (1 + METRIC_COUNT * (METRIC_NAME_MAX + 12) + 4 + RPT_HIST_BUCKETS * 11 + 3)
+
+// ============================================================================
+//                             HELPERS
+// ============================================================================
+uint32_t metrics_cpu_mhz = 80;  // Set by Metrics_Init
+uint32_t metrics_last_cycles;   // DWT stamp of the previous loop pass
+uint32_t metrics_wait_us = 0;   // Clock-independent waits in the current pass
+uint32_t metrics_pass_wait_us;  // ... in the previous pass (Metrics_Loop)
+
+void Metrics_Init(uint32_t cpu_hz) {
+    metrics_cpu_mhz = cpu_hz / 1000000;
+    metrics_last_cycles = HWREG(DWT_CYCCNT);
+}
+
+// Call once at the top of every main loop pass. Returns the length of the
+// previous pass (us); minus metrics_pass_wait_us it is the compute time the
+// clock governor uses as its load measure.
+uint32_t Metrics_Loop() {
+    uint32_t now = HWREG(DWT_CYCCNT);
+    uint32_t us = (now - metrics_last_cycles) / metrics_cpu_mhz;
+    metrics_last_cycles = now;
+
+    metrics_pass_wait_us = (metrics_wait_us < us) ? metrics_wait_us : us;
+    metrics_wait_us = 0;
+    m_loop_count++;
+    if (us > m_loop_max_us) m_loop_max_us = us;
+    return us;
+}
+
+// Around waits that a faster clock cannot shorten (a UART byte, the ADC,
+// a full transmit queue): start = Metrics_Wait_Begin(); ...; Metrics_Wait_End(start);
+uint32_t Metrics_Wait_Begin() {
+    return HWREG(DWT_CYCCNT);
+}
+
+void Metrics_Wait_End(uint32_t start) {
+    metrics_wait_us += (HWREG(DWT_CYCCNT) - start) / metrics_cpu_mhz;
+}
+
+// Call once per second (closes the loops-per-second window)
+void Metrics_Second() {
+    m_loops_per_sec = m_loop_count;
+    m_loop_count = 0;
+}
+
+// Adds one report path latency (in cycles) to the histogram
+void Metrics_Report_Latency(uint32_t cycles) {
+    uint32_t ms = (cycles / metrics_cpu_mhz) >> 10; // ~milliseconds
+    int b = 0;
+    while (ms && b < RPT_HIST_BUCKETS - 1) { ms >>= 1; b++; }
+    m_rpt_hist[b]++;
+}
+
+// Adds an snprintf() result to *len. False if the field was cut short;
+// the caller stops there and the cut field is overwritten.
+bool Metrics_Fits(int n, uint32_t *len, uint32_t room) {
+    if (n < 0 || (uint32_t)n >= room - *len) return false;
+    *len += n;
+    return true;
+}
+
+// Writes the 'D' frame into 'out' (METRIC_FRAME_BYTES always fit) and
+// restarts the "since last read" values. A smaller buffer gets the fields
+// that fit, still ending with "\r\n". Returns the length.
+uint32_t Metrics_Format(char *out, uint32_t size) {
+    uint32_t i, len = 0, room = size - 2; // "\r\n" after the last whole field
+    bool ok = Metrics_Fits(snprintf(out, room, "D"), &len, room);
+
+    for (i = 0; i < METRIC_COUNT && ok; i++)
+        ok = Metrics_Fits(snprintf(out + len, room - len, ";%s=%u",
+                                   metric_table[i].name, *metric_table[i].value), &len, room);
+    for (i = 0; i < RPT_HIST_BUCKETS && ok; i++)
+        ok = Metrics_Fits(snprintf(out + len, room - len, (i == 0) ? ";rh=%u" : ",%u",
+                                   m_rpt_hist[i]), &len, room);
+    memcpy(out + len, "\r\n", 3);
+
+    m_loop_max_us = 0;
+    return len + 2;
+}
+
+#endif
@@ -0,0 +1,318 @@
+// ============================================================================
+//                  SAVED SETTINGS + CLOCK CHECKPOINT (EEPROM)
+// ============================================================================
+// The TM4C123 has 2 KB of on-chip EEPROM (32 blocks of 16 words). Two kinds
+// of record are kept there:
+//
+//   settings    2 slots x 256 bytes at 0x000 / 0x100
+//               message, LCD view, confirmed baud rate, governor pin, LED
+//               curves, alarm level and ADC calibration. A save goes into
+//               the OLDER slot, so a reset in the middle of it leaves the
+//               newer copy intact.
+//   checkpoint  ring of 64 x 16 bytes from 0x200
+//               time of day, every PERSIST_CKPT_MS into the next slot of the
+//               ring, so one slot is programmed only every ~10 minutes.
+//
+// Each record has a sequence number and a checksum that is programmed LAST.
+// At boot the highest sequence with a good checksum wins.
+//
+// Nothing waits for the EEPROM. Once a second the settings are compared
+// with the saved copy, so a burst of commands ends up in one save. A save
+// or checkpoint is then programmed one word per main loop pass with
+// EEPROMProgramNonBlocking(), each word only after the previous one has
+// finished. Words the slot already holds are skipped.
+//
+// Boot: Persist_Init() reads every record (~300 words, well under a
+// millisecond) before the first report. A restored time counts as unsynced
+// ('?' after the time on the LCD, flag in the BOOT line) until the PC sends
+// 'S'. A restored baud rate is treated like a 'B' step: it is only kept if
+// the PC confirms it with "B!" within LINK_VERIFY_MS, otherwise back to 9600.
+//
+// 'E' command: ES = save settings and checkpoint now,
+//              EI = E;<settings seq>;<checkpoint seq>;<busy>
+// ============================================================================
+
+#ifndef _PERSIST_H
+#define _PERSIST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "driverlib/eeprom.h"
+
+#define PERSIST_MAGIC      0x5A430002 // Change when a record layout changes
+#define PERSIST_CFG_ADDR   0x000      // Two settings slots
+#define PERSIST_CFG_SLOT   256        // Bytes per settings slot (4 blocks)
+#define PERSIST_CKPT_ADDR  0x200      // Checkpoint ring
+#define PERSIST_CKPT_SLOTS 64
+#define PERSIST_CHECK_MS   1000       // Settings compared this often
+#define PERSIST_CKPT_MS    10000      // Time checkpoint period
+#define PERSIST_MSG_CHARS  80         // = MSG_MAX in main.c
+#define PERSIST_VIEWS      3          // VIEW_TEXT .. VIEW_BAR
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t baud;
+    uint32_t alarm;
+    uint8_t view;
+    int8_t gov;                          // GOV_AUTO or the pinned level
+    uint8_t pad[2];
+    uint16_t curve[3][LED_CURVE_POINTS];
+    uint16_t pad2;
+    char msg[PERSIST_MSG_CHARS + 4];     // Terminated, zero filled
+    cal_channel_t cal[CAL_CHANNELS];
+    uint32_t sum;                        // Programmed last
+} persist_cfg_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t hms;                        // hours << 16 | minutes << 8 | seconds
+    uint32_t sum;                        // Programmed last
+} persist_ckpt_t;
+
+#define PERSIST_CFG_WORDS  (sizeof(persist_cfg_t) / 4)
+#define PERSIST_CKPT_WORDS (sizeof(persist_ckpt_t) / 4)
+
+// Does not compile if the settings record outgrows its slot
+typedef char persist_cfg_fits[(sizeof(persist_cfg_t) <= PERSIST_CFG_SLOT) ? 1 : -1];
+
+bool persist_ok = false;          // EEPROM initialised
+persist_cfg_t persist_slot[2];    // What each settings slot holds now
+persist_cfg_t persist_new;        // Settings record being saved
+persist_ckpt_t persist_ck;        // Checkpoint being saved
+int persist_cfg_slot = 1;         // Slot with the newest settings
+uint32_t persist_ck_seq = 0;      // Newest checkpoint
+uint32_t persist_ck_next = 0;     // Ring slot for the next one
+uint32_t persist_check_ms = 0;
+uint32_t persist_ck_ms = 0;
+bool persist_save_now = false;    // 'ES'
+bool persist_ckpt_now = false;    // 'ES' or the PC set the time
+
+// Word writer: persist_src[0 .. persist_len-1] -> persist_addr
+const uint32_t *persist_src;
+uint32_t *persist_old;            // Current slot contents (NULL = write all)
+uint32_t persist_addr;
+uint32_t persist_len = 0;
+uint32_t persist_pos = 0;
+
+// Boot result (BOOT line)
+bool persist_cfg_restored = false;
+bool persist_clk_restored = false;
+
+bool time_valid = false;          // Clock set by the PC or restored
+bool time_synced = false;         // Clock set by the PC since reset
+
+// Metrics ('D' frame)
+uint32_t m_ee_words = 0;          // Words programmed
+uint32_t m_ee_saves = 0;          // Settings saves
+uint32_t m_ee_ckpts = 0;          // Checkpoints
+
+extern volatile int hours, minutes, seconds;
+extern char lcd_custom_msg[PERSIST_MSG_CHARS + 1];
+extern int lcd_view;
+char UART_Get();
+void UART_Print(char *str);
+
+// FNV-1a over 32-bit words
+uint32_t Persist_Sum(const void *rec, uint32_t words) {
+    const uint32_t *w = (const uint32_t *)rec;
+    uint32_t s = 0x811C9DC5;
+    while (words--) s = (s ^ *w++) * 16777619;
+    return s;
+}
+
+// True if a record read back from EEPROM is complete (erased = all 0xFF)
+bool Persist_Valid(const void *rec, uint32_t words) {
+    const uint32_t *w = (const uint32_t *)rec;
+    return w[0] == PERSIST_MAGIC && w[words - 1] == Persist_Sum(rec, words - 1);
+}
+
+// Sequence 'a' newer than 'b' (survives wrap-around)
+bool Persist_Newer(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) > 0;
+}
+
+// Current settings -> record (no seq / sum yet)
+void Persist_Fill(persist_cfg_t *r) {
+    int c, i;
+    memset(r, 0, sizeof(*r));
+    r->magic = PERSIST_MAGIC;
+    r->baud = link_verifying ? link_prev_baud : link_baud; // Only confirmed rates
+    r->alarm = led_alarm_level;
+    r->view = (uint8_t)lcd_view;
+    r->gov = (int8_t)gov_pinned;
+    for (c = 0; c < 3; c++)
+        for (i = 0; i < LED_CURVE_POINTS; i++) r->curve[c][i] = led_curve[c][i];
+    strncpy(r->msg, lcd_custom_msg, PERSIST_MSG_CHARS);
+    memcpy(r->cal, cal, sizeof(r->cal));
+}
+
+// Settings that differ from the newest saved copy (seq / sum not compared)
+bool Persist_Changed(const persist_cfg_t *a, const persist_cfg_t *b) {
+    return a->magic != b->magic ||
+           memcmp(&a->baud, &b->baud, offsetof(persist_cfg_t, sum) - offsetof(persist_cfg_t, baud)) != 0;
+}
+
+// Puts a restored settings record into effect. Each field is checked on its
+// own, a value the firmware would never send is left at its default.
+void Persist_Apply(const persist_cfg_t *r) {
+    uint32_t i;
+    int c;
+
+    for (i = 0; i < LINK_RATE_COUNT; i++)
+        if (link_rates[i] == r->baud) Link_Resume(r->baud);
+    if (r->alarm <= 4095) led_alarm_level = r->alarm;
+    if (r->view < PERSIST_VIEWS) lcd_view = r->view;
+    if (r->gov == GOV_AUTO || (r->gov >= 0 && r->gov < (int)GOV_LEVEL_COUNT)) gov_pinned = r->gov;
+    for (c = 0; c < 3; c++)
+        for (i = 0; i < LED_CURVE_POINTS; i++)
+            if (r->curve[c][i] <= 1000) led_curve[c][i] = r->curve[c][i];
+    memcpy(lcd_custom_msg, r->msg, PERSIST_MSG_CHARS);
+    lcd_custom_msg[PERSIST_MSG_CHARS] = '\0';
+    for (c = 0; c < CAL_CHANNELS; c++) {
+        if (r->cal[c].dec > 3 || r->cal[c].unit[CAL_UNIT_MAX] != '\0') continue;
+        cal[c] = r->cal[c];
+    }
+}
+
+// Enables the EEPROM and restores the newest settings and checkpoint.
+// Call once at boot, after the UART is set up and before Timer0 starts.
+void Persist_Init(uint32_t now_ms) {
+    persist_ckpt_t ck;
+    uint32_t i, best = 0;
+    bool found = false;
+    int s;
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_EEPROM0);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_EEPROM0));
+    if (EEPROMInit() != EEPROM_INIT_OK) return; // Runs without saving
+    persist_ok = true;
+    persist_check_ms = persist_ck_ms = now_ms;
+
+    // Settings: the valid slot with the higher sequence
+    for (s = 0; s < 2; s++)
+        EEPROMRead((uint32_t *)&persist_slot[s], PERSIST_CFG_ADDR + s * PERSIST_CFG_SLOT, sizeof(persist_cfg_t));
+    for (s = 0; s < 2; s++) {
+        if (!Persist_Valid(&persist_slot[s], PERSIST_CFG_WORDS)) continue;
+        if (!persist_cfg_restored || Persist_Newer(persist_slot[s].seq, persist_slot[persist_cfg_slot].seq)) {
+            persist_cfg_slot = s;
+            persist_cfg_restored = true;
+        }
+    }
+    if (persist_cfg_restored) Persist_Apply(&persist_slot[persist_cfg_slot]);
+
+    // Checkpoint: the valid ring slot with the highest sequence
+    for (i = 0; i < PERSIST_CKPT_SLOTS; i++) {
+        EEPROMRead((uint32_t *)&ck, PERSIST_CKPT_ADDR + i * sizeof(ck), sizeof(ck));
+        if (!Persist_Valid(&ck, PERSIST_CKPT_WORDS)) continue;
+        if (!found || Persist_Newer(ck.seq, persist_ck_seq)) {
+            found = true;
+            best = i;
+            persist_ck_seq = ck.seq;
+            persist_ck.hms = ck.hms;
+        }
+    }
+    if (found) {
+        persist_ck_next = (best + 1) % PERSIST_CKPT_SLOTS;
+        if ((persist_ck.hms >> 16) < 24 && ((persist_ck.hms >> 8) & 0xFF) < 60 && (persist_ck.hms & 0xFF) < 60) {
+            hours = persist_ck.hms >> 16;
+            minutes = (persist_ck.hms >> 8) & 0xFF;
+            seconds = persist_ck.hms & 0xFF;
+            time_valid = true;
+            persist_clk_restored = true; // time_synced stays false
+        }
+    }
+}
+
+// Called when the PC sets the clock ('S')
+void Persist_Time_Set() {
+    time_valid = true;
+    time_synced = true;
+    persist_ckpt_now = true;
+}
+
+// True while a record is being written (the governor does not change the
+// clock under a running EEPROM program)
+bool Persist_Busy() {
+    if (!persist_ok) return false;
+    return persist_pos < persist_len || (EEPROMStatusGet() & EEPROM_RC_WORKING);
+}
+
+void Persist_Start(const void *src, uint32_t *old, uint32_t addr, uint32_t words) {
+    persist_src = (const uint32_t *)src;
+    persist_old = old;
+    persist_addr = addr;
+    persist_len = words;
+    persist_pos = 0;
+}
+
+// Call every main loop pass. Programs at most one word and never waits.
+void Persist_Poll(uint32_t now_ms) {
+    int h, m, s;
+
+    if (!persist_ok) return;
+
+    if (persist_pos < persist_len) {
+        if (EEPROMStatusGet() & EEPROM_RC_WORKING) return; // Previous word still going
+        while (persist_old && persist_pos < persist_len &&
+               persist_old[persist_pos] == persist_src[persist_pos]) persist_pos++;
+        if (persist_pos == persist_len) return;
+        EEPROMProgramNonBlocking(persist_src[persist_pos], persist_addr + persist_pos * 4);
+        if (persist_old) persist_old[persist_pos] = persist_src[persist_pos];
+        persist_pos++;
+        m_ee_words++;
+        return;
+    }
+
+    // Idle: settings first, then the checkpoint
+    if (persist_save_now || now_ms - persist_check_ms >= PERSIST_CHECK_MS) {
+        persist_check_ms = now_ms;
+        Persist_Fill(&persist_new);
+        if (persist_save_now || Persist_Changed(&persist_new, &persist_slot[persist_cfg_slot])) {
+            persist_save_now = false;
+            persist_new.seq = persist_slot[persist_cfg_slot].seq + 1;
+            persist_new.sum = Persist_Sum(&persist_new, PERSIST_CFG_WORDS - 1);
+            persist_cfg_slot ^= 1; // Overwrite the older copy
+            Persist_Start(&persist_new, (uint32_t *)&persist_slot[persist_cfg_slot],
+                          PERSIST_CFG_ADDR + persist_cfg_slot * PERSIST_CFG_SLOT, PERSIST_CFG_WORDS);
+            m_ee_saves++;
+            return;
+        }
+    }
+
+    if (time_valid && (persist_ckpt_now || now_ms - persist_ck_ms >= PERSIST_CKPT_MS)) {
+        persist_ckpt_now = false;
+        persist_ck_ms = now_ms;
+        do { // Timer0 may tick in between
+            s = seconds; m = minutes; h = hours;
+        } while (s != seconds);
+        persist_ck.magic = PERSIST_MAGIC;
+        persist_ck.seq = ++persist_ck_seq;
+        persist_ck.hms = (uint32_t)h << 16 | (uint32_t)m << 8 | (uint32_t)s;
+        persist_ck.sum = Persist_Sum(&persist_ck, PERSIST_CKPT_WORDS - 1);
+        Persist_Start(&persist_ck, NULL, PERSIST_CKPT_ADDR + persist_ck_next * sizeof(persist_ck), PERSIST_CKPT_WORDS);
+        persist_ck_next = (persist_ck_next + 1) % PERSIST_CKPT_SLOTS;
+        m_ee_ckpts++;
+    }
+}
+
+// 'E' command (the letter is already read)
+bool Persist_Command(char *buf) {
+    char c = UART_Get();
+    if (c == 'S') {
+        persist_save_now = true;
+        persist_ckpt_now = time_valid;
+    } else if (c == 'I') {
+        sprintf(buf, "E;%u;%u;%d\r\n", persist_slot[persist_cfg_slot].seq, persist_ck_seq, Persist_Busy());
+        UART_Print(buf);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+#endif
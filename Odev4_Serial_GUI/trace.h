@@ -0,0 +1,139 @@
+// ============================================================================
+//                        HOT-PATH TRACE RING BUFFER
+// ============================================================================
+// Every TRACE(id, arg) call stores one fixed-size 8-byte record in RAM:
+//     cycles (32 bit) | event id (16 bit) | argument (16 bit)
+// 'cycles' comes from the Cortex-M4 DWT cycle counter (1 count = 1 CPU clock,
+// wraps every ~53 s at 80 MHz), so recording costs a handful of instructions
+// and can stay enabled in production. The ring keeps the last TRACE_SIZE
+// events; older ones are overwritten.
+//
+// Event ids 0x10 and up come in pairs: an EVEN id starts a span and the
+// next ODD id ends it. The PC viewer uses that rule for latency statistics.
+//
+// Dump ('T' command), one line per record so it fits the text protocol:
+//     TRACE;<count>;<cpu_hz>
+//     T;<id hex4>;<cycles hex8>;<arg hex4>     (count times)
+//     TRACE;END
+// Recording pauses while the dump is in progress, so the dump is a snapshot.
+// ============================================================================
+
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+
+// Set to 0 to compile every TRACE() call away
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+#define TRACE_SIZE 256 // Records in the ring (power of two, 8 bytes each)
+
+// Cortex-M4 debug registers used for the cycle counter
+#define DEMCR          0xE000EDFC // Debug Exception and Monitor Control
+#define DEMCR_TRCENA   0x01000000 // Enables the DWT unit
+#define DWT_CTRL       0xE0001000
+#define DWT_CYCCNTENA  0x00000001
+#define DWT_CYCCNT     0xE0001004
+
+// ============================================================================
+//                             EVENT IDS
+// ============================================================================
+#define TR_TIMER0       0x01 // Timer0 ISR (arg = seconds)
+#define TR_CMD_RX       0x02 // Command letter received (arg = letter)
+#define TR_CLOCK        0x03 // Clock switch (arg = old MHz << 8 | new MHz)
+#define TR_ADC_BEGIN    0x10 // ADC trigger ... result read (arg = value)
+#define TR_ADC_END      0x11
+#define TR_UART_BEGIN   0x12 // Report transmit (arg = bytes)
+#define TR_UART_END     0x13
+#define TR_LCD_BEGIN    0x14 // View redraw (arg = view)
+#define TR_LCD_END      0x15
+#define TR_SCROLL_BEGIN 0x16 // Marquee step
+#define TR_SCROLL_END   0x17
+
+typedef struct {
+    uint32_t cycles;
+    uint16_t id;
+    uint16_t arg;
+} trace_rec_t;
+
+trace_rec_t trace_ring[TRACE_SIZE];
+volatile uint32_t trace_head = 0;   // Total records written (index = head % size)
+volatile bool trace_paused = false; // TRUE while a dump is running
+
+// Starts the DWT cycle counter
+void Trace_Init() {
+    HWREG(DEMCR) |= DEMCR_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CYCCNTENA;
+}
+
+// Stores one record. Safe to call from interrupts and the main loop.
+void Trace_Record(uint16_t id, uint16_t arg) {
+    uint32_t i;
+    bool was_off;
+
+    if (trace_paused) return;
+
+    // Reserve a slot with interrupts off (a few cycles)
+    was_off = IntMasterDisable();
+    i = trace_head++ & (TRACE_SIZE - 1);
+    if (!was_off) IntMasterEnable();
+
+    trace_ring[i].cycles = HWREG(DWT_CYCCNT);
+    trace_ring[i].id = id;
+    trace_ring[i].arg = arg;
+}
+
+#if TRACE_ENABLED
+#define TRACE(id, arg) Trace_Record((id), (uint16_t)(arg))
+#else
+#define TRACE(id, arg)
+#endif
+
+// ============================================================================
+//                             DUMP
+// ============================================================================
+// The dump is sent ONE LINE per call so the main loop keeps running
+// (a full ring is ~6 KB of text, several seconds at 9600 baud).
+uint32_t trace_dump_next = 0; // Next record to send
+uint32_t trace_dump_end = 0;  // One past the last record
+bool trace_dumping = false;
+
+// Freezes the ring and prepares the dump. Writes the header into 'line'.
+void Trace_Dump_Start(char *line, uint32_t cpu_hz) {
+    uint32_t count;
+
+    trace_paused = true;
+    count = (trace_head < TRACE_SIZE) ? trace_head : TRACE_SIZE;
+    trace_dump_end = trace_head;
+    trace_dump_next = trace_head - count;
+    trace_dumping = true;
+
+    sprintf(line, "TRACE;%u;%u\r\n", count, cpu_hz);
+}
+
+// Formats the next dump line into 'line'. Returns FALSE when nothing is left.
+bool Trace_Dump_Line(char *line) {
+    trace_rec_t *r;
+
+    if (!trace_dumping) return false;
+
+    if (trace_dump_next == trace_dump_end) {
+        sprintf(line, "TRACE;END\r\n");
+        trace_dumping = false;
+        trace_paused = false; // Resume recording
+        return true;
+    }
+
+    r = &trace_ring[trace_dump_next++ & (TRACE_SIZE - 1)];
+    sprintf(line, "T;%04X;%08X;%04X\r\n", r->id, r->cycles, r->arg);
+    return true;
+}
+
+#endif
@@ -1,5 +1,6 @@
 ﻿using System;
 using System.Drawing;
+using System.IO;
 using System.Windows.Forms;
 using System.IO.Ports;
 
@@ -7,6 +8,60 @@ namespace MicrocontrollerProject
 {
     public partial class MainForm : Form
     {
+        // Must match MSG_MAX in main.c
+        const int MaxMessageLength = 80;
+
+        // 'T' komutu ile istenen trace dökümü (null = döküm beklenmiyor)
+        TraceDump traceDump;
+        TraceViewerForm traceViewer;
+
+        // Teşhis paneli ve 'D' sorgulama zamanlayıcısı
+        DiagnosticsForm diagForm;
+        readonly Timer diagTimer = new Timer();
+
+        // Arka plan alım hattı: okuma + ayrıştırma UI thread'inin dışında yapılır,
+        // UI kuyrukları ekran yenileme hızında (UiFrameMs) boşaltır.
+        const int UiFrameMs = 16;
+        TelemetryPipeline pipeline;
+        System.Threading.Timer uiTimer;
+        int drainPending; // 1 = a drain is already queued on the UI thread
+        bool linkErrorShown;
+        bool clockUnsynced; // BOOT said the clock came from an EEPROM checkpoint
+
+        // Canlı ADC grafiği (formun altına eklenir)
+        readonly AdcChart adcChart = new AdcChart();
+
+        // Kayıt (.tlog) ve tekrar oynatma
+        ToolStripMenuItem menuRecord;
+        TelemetryLogWriter recorder;
+        TelemetryLogReader replayLog; // != null while a replay is running
+
+        // Gecikme ölçümü: panel açıkken cihaz 'L1' modunda, her saniye 'Q' gönderilir
+        LatencyForm latencyForm;
+        readonly LatencyStats latencyStats = new LatencyStats();
+        readonly ClockSync clockSync = new ClockSync();
+        readonly Timer latencyTimer = new Timer();
+        bool latencyOn;
+
+        // Baud pazarlığı sürerken port başka kimseye ait değil
+        LinkForm linkForm;
+        bool linkBusy;
+
+        // Çoklu kart paneli (kendi portlarını açar, serialPort1'den bağımsız)
+        FleetForm fleetForm;
+
+        // RGB LED eğrileri ('W' komutu)
+        LedForm ledForm;
+
+        // ADC kalibrasyonu ('K' komutu); cihazla aynı tablo, değeri birimiyle göstermek için
+        CalibrationForm calForm;
+        CalTable calTable = CalTable.Default();
+
+        // Sanal cihaz: kart olmadan alım hattını ve arayüzü yükler
+        EmulatorForm emulatorForm;
+        DeviceEmulatorStream emulator; // != null while it feeds the pipeline
+        long uiSamples;                // Samples the UI has taken (backlog = parsed - dropped - this)
+
         public MainForm()
         {
             InitializeComponent();
@@ -15,18 +70,296 @@ namespace MicrocontrollerProject
             serialPort1.DataBits = 8;
             serialPort1.StopBits = StopBits.One;
             serialPort1.Parity = Parity.None;
+
+            // Okuma artık TelemetryPipeline'da (ReadLine + Invoke yerine)
+            serialPort1.DataReceived -= SerialPort1DataReceived;
+
+            BuildToolsMenu();
+
+            adcChart.Dock = DockStyle.Bottom;
+            adcChart.Height = 220;
+            Height += adcChart.Height;
+            Controls.Add(adcChart);
+
+            diagTimer.Interval = 1000;
+            diagTimer.Tick += DiagTimerTick;
+
+            latencyTimer.Interval = 1000;
+            latencyTimer.Tick += LatencyTimerTick;
+        }
+
+        // Araçlar menüsü (formun üstündeki boş alana yerleşir)
+        void BuildToolsMenu()
+        {
+            MenuStrip menu = new MenuStrip();
+            ToolStripMenuItem tools = new ToolStripMenuItem("Tools");
+            tools.DropDownItems.Add(new ToolStripMenuItem("Trace Viewer", null, MenuTraceClick));
+            tools.DropDownItems.Add(new ToolStripMenuItem("Diagnostics", null, MenuDiagnosticsClick));
+            tools.DropDownItems.Add(new ToolStripMenuItem("Latency", null, MenuLatencyClick));
+            tools.DropDownItems.Add(new ToolStripMenuItem("Link Speed", null, MenuLinkClick));
+            tools.DropDownItems.Add(new ToolStripMenuItem("Fleet Monitor", null, MenuFleetClick));
+            tools.DropDownItems.Add(new ToolStripMenuItem("LED Mapping", null, MenuLedClick));
+            tools.DropDownItems.Add(new ToolStripMenuItem("ADC Calibration", null, MenuCalibrationClick));
+            tools.DropDownItems.Add(new ToolStripMenuItem("Device Emulator", null, MenuEmulatorClick));
+            tools.DropDownItems.Add(new ToolStripSeparator());
+
+            menuRecord = new ToolStripMenuItem("Record Log");
+            menuRecord.CheckOnClick = true;
+            menuRecord.Checked = true;
+            tools.DropDownItems.Add(menuRecord);
+
+            ToolStripMenuItem replay = new ToolStripMenuItem("Replay Log");
+            foreach (double speed in new double[] { 1, 10, 100, 0 }) {
+                double sp = speed;
+                string name = (sp > 0) ? sp + "x" : "Max speed";
+                replay.DropDownItems.Add(new ToolStripMenuItem(name, null, delegate { MenuReplayClick(sp); }));
+            }
+            tools.DropDownItems.Add(replay);
+            menu.Items.Add(tools);
+            Controls.Add(menu);
+            MainMenuStrip = menu;
+        }
+
+        // 5. TRACE DÖKÜMÜ: cihazdan trace ring'ini ister, gelince pencerede gösterir
+        void MenuTraceClick(object sender, EventArgs e)
+        {
+            if (!serialPort1.IsOpen) {
+                MessageBox.Show("Please connect first!");
+                return;
+            }
+            traceDump = new TraceDump();
+            serialPort1.Write("T");
+        }
+
+        // 6. TEŞHİS PANELİ: açıkken her saniye cihazdan sayaçları ister
+        void MenuDiagnosticsClick(object sender, EventArgs e)
+        {
+            if (diagForm == null || diagForm.IsDisposed) {
+                diagForm = new DiagnosticsForm();
+                diagForm.FormClosing += delegate { diagTimer.Stop(); };
+            }
+            diagForm.Show();
+            diagForm.BringToFront();
+            diagTimer.Start();
+        }
+
+        void DiagTimerTick(object sender, EventArgs e)
+        {
+            if (serialPort1.IsOpen && !linkBusy) serialPort1.Write("D");
+        }
+
+        // 8. GECİKME ÖLÇÜMÜ: ADC dönüşümünden ekrana kadar aşama aşama süreler
+        void MenuLatencyClick(object sender, EventArgs e)
+        {
+            if (!serialPort1.IsOpen) {
+                MessageBox.Show("Please connect first!");
+                return;
+            }
+            if (latencyForm == null || latencyForm.IsDisposed) {
+                latencyForm = new LatencyForm();
+                latencyForm.FormClosing += delegate {
+                    latencyTimer.Stop();
+                    latencyOn = false;
+                    if (serialPort1.IsOpen) serialPort1.Write("L0");
+                };
+            }
+            latencyStats.Clear();
+            latencyOn = true;
+            serialPort1.Write("L1");
+            latencyForm.Show();
+            latencyForm.BringToFront();
+            latencyTimer.Start();
+        }
+
+        void LatencyTimerTick(object sender, EventArgs e)
+        {
+            if (serialPort1.IsOpen && !linkBusy) {
+                clockSync.BeginProbe();
+                serialPort1.Write("Q");
+            }
+            latencyForm.ShowStats(latencyStats, clockSync);
+        }
+
+        // 9. BAĞLANTI HIZI: 9600'den başlayıp daha yüksek baud dener (link.h)
+        void MenuLinkClick(object sender, EventArgs e)
+        {
+            if (!serialPort1.IsOpen || replayLog != null || linkBusy) {
+                MessageBox.Show("Please connect first!");
+                return;
+            }
+            if (linkForm == null || linkForm.IsDisposed) linkForm = new LinkForm();
+            linkForm.Show();
+            linkForm.BringToFront();
+
+            // The pipeline's pending read would steal the replies: stop it and
+            // reopen the port so the negotiator has it to itself
+            linkBusy = true;
+            StopPipeline();
+            serialPort1.Close();
+            serialPort1.Open();
+
+            LinkNegotiator neg = new LinkNegotiator(serialPort1);
+            neg.Log = line => BeginInvoke(new MethodInvoker(delegate { linkForm.Append(line); }));
+            System.Threading.Tasks.Task.Run(delegate {
+                string result;
+                try {
+                    result = "Link is now " + neg.Run(LinkNegotiator.Rates[0]) + " baud";
+                } catch (Exception ex) {
+                    result = "Negotiation aborted: " + ex.Message;
+                }
+                BeginInvoke(new MethodInvoker(delegate {
+                    linkForm.Append(result);
+                    StartPipeline(serialPort1.BaseStream);
+                    linkBusy = false;
+                    Text = "MicrocontrollerProject - " + serialPort1.BaudRate + " baud";
+                }));
+            });
+        }
+
+        void MenuFleetClick(object sender, EventArgs e)
+        {
+            if (fleetForm == null || fleetForm.IsDisposed) fleetForm = new FleetForm();
+            fleetForm.Show();
+            fleetForm.BringToFront();
+        }
+
+        // 10. LED EŞLEME: ADC -> RGB LED parlaklık eğrileri ve alarm seviyesi
+        void MenuLedClick(object sender, EventArgs e)
+        {
+            if (ledForm == null || ledForm.IsDisposed) {
+                ledForm = new LedForm(command => {
+                    if (serialPort1.IsOpen && !linkBusy) serialPort1.Write(command);
+                    else MessageBox.Show("Please connect first!");
+                });
+            }
+            ledForm.Show();
+            ledForm.BringToFront();
+        }
+
+        // 12. ADC KALİBRASYONU: iki nokta / tablo yükler, rapordaki ham değer birime çevrilir
+        void MenuCalibrationClick(object sender, EventArgs e)
+        {
+            if (calForm == null || calForm.IsDisposed) {
+                calForm = new CalibrationForm(command => {
+                    if (serialPort1.IsOpen && !linkBusy) serialPort1.Write(command);
+                    else MessageBox.Show("Please connect first!");
+                }, table => calTable = table, calTable);
+            }
+            calForm.Show();
+            calForm.BringToFront();
+        }
+
+        // 11. SANAL CİHAZ: sentetik raporlarla ana pencereyi besler veya benchmark çalıştırır
+        void MenuEmulatorClick(object sender, EventArgs e)
+        {
+            if (emulatorForm == null || emulatorForm.IsDisposed)
+                emulatorForm = new EmulatorForm(FeedFromEmulator, EmulatorStatus);
+            emulatorForm.Show();
+            emulatorForm.BringToFront();
+        }
+
+        // Starts the pipeline on an emulator (settings == null stops it)
+        DeviceEmulatorStream FeedFromEmulator(EmulatorSettings settings)
+        {
+            if (settings == null) {
+                if (emulator != null) StopEmulator();
+                return null;
+            }
+            if (serialPort1.IsOpen || replayLog != null || emulator != null) {
+                MessageBox.Show("Stop the current connection first!");
+                return null;
+            }
+            emulator = new DeviceEmulatorStream(settings);
+            uiSamples = 0;
+            StartPipeline(emulator);
+            btnConnect.Text = "Stop";
+            btnConnect.BackColor = Color.LightBlue;
+            return emulator;
+        }
+
+        void StopEmulator()
+        {
+            StopPipeline();
+            emulator = null;
+            btnConnect.Text = "Start";
+            btnConnect.BackColor = Color.LightGray;
+        }
+
+        string EmulatorStatus()
+        {
+            TelemetryPipeline p = pipeline;
+            if (p == null || emulator == null) return "";
+            return "parsed " + p.SamplesParsed + ", bad " + p.BadLines + ", dropped " + p.DroppedSamples
+                + "\r\nUI took " + uiSamples + ", backlog " + (p.SamplesParsed - p.DroppedSamples - uiSamples);
+        }
+
+        // 7. KAYIT TEKRARI: .tlog dosyasını canlı bağlantıyla aynı hattan geçirir
+        void MenuReplayClick(double speed)
+        {
+            if (serialPort1.IsOpen || replayLog != null) {
+                MessageBox.Show("Stop the current connection first!");
+                return;
+            }
+            using (OpenFileDialog dlg = new OpenFileDialog()) {
+                dlg.Filter = "Telemetry log (*.tlog)|*.tlog";
+                dlg.InitialDirectory = LogDirectory;
+                if (dlg.ShowDialog() != DialogResult.OK) return;
+                try {
+                    replayLog = new TelemetryLogReader(dlg.FileName);
+                } catch (Exception ex) {
+                    MessageBox.Show("Cannot open log: " + ex.Message);
+                    return;
+                }
+            }
+            StartPipeline(new LogReplayStream(replayLog, speed, 0));
+            btnConnect.Text = "Stop";
+            btnConnect.BackColor = Color.LightBlue;
+        }
+
+        void StopReplay()
+        {
+            StopPipeline();
+            replayLog.Dispose();
+            replayLog = null;
+            btnConnect.Text = "Start";
+            btnConnect.BackColor = Color.LightGray;
+        }
+
+        static string LogDirectory
+        {
+            get { return Path.Combine(Application.StartupPath, "logs"); }
+        }
+
+        void ShowTrace(TraceDump dump)
+        {
+            if (traceViewer == null || traceViewer.IsDisposed) traceViewer = new TraceViewerForm();
+            traceViewer.LoadDump(dump);
+            traceViewer.Show();
+            traceViewer.BringToFront();
         }
 
         // 1. BAĞLANTI BUTONU (btnConnect -> Click Olayına Bağla)
         void BtnConnectClick(object sender, EventArgs e)
         {
+            if (replayLog != null) { StopReplay(); return; }
+            if (emulator != null) { StopEmulator(); return; }
             try {
                 if (!serialPort1.IsOpen) {
                     serialPort1.PortName = txtPort.Text; // Örn: COM3
                     serialPort1.Open();
+                    StartPipeline(serialPort1.BaseStream);
+                    serialPort1.Write("K?"); // A running board may already have its own table
                     btnConnect.Text = "Stop";
                     btnConnect.BackColor = Color.LightGreen; // Görsel ipucu
                 } else {
+                    StopPipeline();
+                    // Leave the device at the default rate for the next connection
+                    if (serialPort1.BaudRate != 9600) {
+                        serialPort1.Write("B9600\n");
+                        System.Threading.Thread.Sleep(50); // Its reply leaves at the old rate
+                        serialPort1.BaudRate = 9600;
+                        serialPort1.Handshake = Handshake.None; // 9600 needs no "B!"
+                    }
                     serialPort1.Close();
                     btnConnect.Text = "Start";
                     btnConnect.BackColor = Color.LightGray;
@@ -43,6 +376,10 @@ namespace MicrocontrollerProject
             {
                 // Tiva C "S" + 8 karakter bekliyor (Örn: S12:30:00)
                 serialPort1.Write("S" + txtTimeIn.Text);
+                if (clockUnsynced) {
+                    clockUnsynced = false;
+                    Text = "MicrocontrollerProject";
+                }
             }
         }
 
@@ -52,14 +389,14 @@ namespace MicrocontrollerProject
 {
     if (serialPort1.IsOpen) 
     {
-        string msg = txtMsgIn.Text;
+        // Line breaks end the command on the device side, so strip them
+        string msg = txtMsgIn.Text.Replace("\r", " ").Replace("\n", " ");
 
-        // Force exactly 3 characters (e.g. "A" becomes "A  ")
-        if (msg.Length > 3) msg = msg.Substring(0, 3);
-        while(msg.Length < 3) msg += " "; 
+        // Device keeps at most MSG_MAX (80) characters and scrolls long text
+        if (msg.Length > MaxMessageLength) msg = msg.Substring(0, MaxMessageLength);
 
-        // Send 'M' + the 3 characters
-        serialPort1.Write("M" + msg);
+        // Send 'M' + the text + end of line
+        serialPort1.Write("M" + msg + "\n");
     }
     else 
     {
@@ -67,27 +404,141 @@ namespace MicrocontrollerProject
     }
 }
 
-        // 4. VERİ ALMA (serialPort1 -> DataReceived Olayına Bağla)
+        // 4. VERİ ALMA
+        // Designer'daki DataReceived bağlantısı için duruyor; constructor'da
+        // ayrılıyor. Okuma TelemetryPipeline içinde yapılır.
         void SerialPort1DataReceived(object sender, SerialDataReceivedEventArgs e)
         {
-            try 
-            {
-                // Gelen veri formatı: "12:00:00;3.14;0"
-                string data = serialPort1.ReadLine(); 
-                string[] parts = data.Split(';'); 
-
-                if (parts.Length == 3) {
-                    // Arayüzü güncellemek için Invoke (Zorunlu)
-                    this.Invoke(new MethodInvoker(delegate {
-                        txtTimeOut.Text = parts[0];     // Saat
-                        txtAdcOut.Text = parts[1];      // Voltaj
-                        
-                        // Buton "0" ise Basıldı, "1" ise Bırakıldı (Tiva C Pull-up mantığı)
-                        txtStatus.Text = (parts[2].Trim() == "1") ? "Pressed" : "Released";
-                    }));
+        }
+
+        void StartPipeline(Stream source)
+        {
+            pipeline = new TelemetryPipeline(source);
+            pipeline.Clock = clockSync;
+            clockSync.BaudRate = serialPort1.BaudRate;
+            // Live data only; a replay is already on disk
+            if (menuRecord.Checked && replayLog == null && emulator == null) {
+                try {
+                    recorder = TelemetryLogWriter.CreateIn(LogDirectory);
+                    pipeline.Recorder = recorder;
+                } catch (IOException ex) {
+                    MessageBox.Show("Recording disabled: " + ex.Message);
+                }
+            }
+            pipeline.Start();
+            linkErrorShown = false;
+            uiTimer = new System.Threading.Timer(UiTimerCallback, null, UiFrameMs, UiFrameMs);
+        }
+
+        void StopPipeline()
+        {
+            if (uiTimer != null) { uiTimer.Dispose(); uiTimer = null; }
+            if (pipeline != null) { pipeline.Stop(); pipeline = null; }
+            if (recorder != null) { recorder.Dispose(); recorder = null; }
+        }
+
+        // Window closing while connected: the recorder writes its last,
+        // partial block only when disposed, and the UI timer must be gone
+        // before the handle is
+        protected override void OnFormClosing(FormClosingEventArgs e)
+        {
+            base.OnFormClosing(e);
+            if (!e.Cancel) StopPipeline();
+        }
+
+        // Thread-pool timer: posts at most ONE drain to the UI thread at a time,
+        // so a busy UI never builds up a backlog of queued updates.
+        void UiTimerCallback(object state)
+        {
+            if (!IsHandleCreated || IsDisposed) return;
+            if (System.Threading.Interlocked.Exchange(ref drainPending, 1) != 0) return;
+            try {
+                BeginInvoke(new MethodInvoker(DrainTelemetry));
+            } catch (InvalidOperationException) {
+                // Handle destroyed after the check above (window closing)
+                System.Threading.Interlocked.Exchange(ref drainPending, 0);
+            }
+        }
+
+        // Runs on the UI thread once per frame
+        void DrainTelemetry()
+        {
+            try {
+                TelemetryPipeline p = pipeline;
+                if (p == null) return;
+
+                // Only the newest sample is shown in the text boxes
+                TelemetrySample s, last = new TelemetrySample();
+                bool any = false;
+                // ...but every sample goes into the chart history
+                while (p.TryTakeSample(out s)) {
+                    uiSamples++;
+                    adcChart.Add(s.Adc);
+                    if (latencyOn) latencyStats.AddSample(ref s, clockSync);
+                    last = s;
+                    any = true;
+                }
+
+                if (any) {
+                    txtTimeOut.Text = last.TimeText;   // Saat
+                    txtAdcOut.Text = last.Adc + " (" + calTable.Format(last.Adc) + ")"; // ADC + birim
+
+                    // Tiva C tarafında buton kilitlendiyse (latch) 1 gelir
+                    txtStatus.Text = last.Button ? "Pressed" : "Released";
+                    adcChart.Invalidate();
+
+                    if (latencyOn) {
+                        txtAdcOut.Update(); // Paint now so the stamp means "on screen"
+                        latencyStats.AddShown(ref last, System.Diagnostics.Stopwatch.GetTimestamp(), clockSync);
+                    }
                 }
+
+                string line;
+                while (p.TextLines.TryDequeue(out line)) HandleTextLine(line);
+
+                if (p.LastError != null && !linkErrorShown) {
+                    linkErrorShown = true;
+                    Text = "MicrocontrollerProject - link error: " + p.LastError.Message;
+                }
+            }
+            finally {
+                System.Threading.Interlocked.Exchange(ref drainPending, 0);
+            }
+        }
+
+        // Rapor olmayan satırlar: trace dökümü, teşhis cevabı, BOOT
+        void HandleTextLine(string line)
+        {
+            TraceDump dump = traceDump;
+            if (dump != null && dump.Feed(line)) {
+                if (dump.Complete) {
+                    traceDump = null;
+                    ShowTrace(dump);
+                }
+                return;
+            }
+
+            // BOOT;<us>;<settings>;<clock>: the device restarted. A baud rate it
+            // restored from EEPROM falls back to 9600 unless confirmed; this line
+            // just arrived intact at it, so confirm it, and fetch the calibration.
+            if (line.StartsWith("BOOT;")) {
+                string[] f = line.Split(';');
+                if (serialPort1.IsOpen) serialPort1.Write("B!\nK?");
+                if (f.Length >= 4 && f[3] == "1") {
+                    clockUnsynced = true;
+                    Text = "MicrocontrollerProject - device clock restored from checkpoint, press Sync Time";
+                }
+                return;
             }
-            catch { /* Hata olursa program çökmesin diye boş bırakıldı */ }
+
+            CalTable cal = CalTable.Parse(line);
+            if (cal != null) {
+                if (cal.Channel == 0) calTable = cal;
+                return;
+            }
+
+            var diag = DiagnosticsFrame.Parse(line);
+            if (diag != null && diagForm != null && !diagForm.IsDisposed) diagForm.ShowFrame(diag);
         }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,179 @@
+// ============================================================================
+//                    UART0 TRANSMIT THROUGH uDMA (FRAME QUEUE)
+// ============================================================================
+// Every outgoing line (report, 'D' frame, trace line, replies) is a FRAME in
+// one of TX_SLOTS fixed buffers. uDMA channel 9 (UART0 TX) copies a frame
+// into the TX FIFO by itself; the CPU only writes the frame and hands it
+// over, so sending costs the same no matter how long the frame is.
+//
+//   producer (main loop)                     UART0 interrupt
+//   Tx_Reserve() -> format in place          DMA finished: tx_done++
+//   Tx_Commit()  -> starts DMA if idle       next frame queued? start it
+//
+// Back-to-back frames: the DMA request fires while the FIFO still holds
+// about 8 bytes (TX4_8 level), so the interrupt starts the next frame long
+// before the line runs dry (8 byte times = 87 us even at 921600 baud).
+// If the FIFO was empty anyway, 'txg' counts a gap.
+//
+// Tx_Commit() returns the frame number; Tx_Done(n) tells the producer when
+// that frame has left the queue. When all slots are full the producer waits
+// (counted in 'txw'), the same back pressure the old blocking UART_Print had.
+//
+// Idle line time: from the end of the last queued frame to the start of the
+// next one, summed in 'txi' (ms). It starts when the DMA finishes, so it is
+// early by the few bytes still in the FIFO.
+// ============================================================================
+
+#ifndef _UART_TX_H
+#define _UART_TX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "inc/hw_uart.h"
+#include "driverlib/udma.h"
+#include "trace.h"   // DWT cycle counter
+#include "metrics.h" // METRIC_FRAME_BYTES
+
+#define TX_SLOTS      8   // Frames in the queue
+#define TX_SLOT_BYTES METRIC_FRAME_BYTES // Longest frame: the worst case 'D' frame; uDMA max is 1024
+#define TX_DMA_CH     UDMA_CH9_UART0TX
+
+// uDMA control table: must be 1024-byte aligned
+#if defined(__TI_COMPILER_VERSION__)
+#pragma DATA_ALIGN(udma_table, 1024)
+uint8_t udma_table[1024];
+#else
+uint8_t udma_table[1024] __attribute__((aligned(1024)));
+#endif
+
+char tx_slot[TX_SLOTS][TX_SLOT_BYTES];
+uint16_t tx_len[TX_SLOTS];
+volatile uint32_t tx_put = 0;     // Frames committed (main loop)
+volatile uint32_t tx_started = 0; // Frames given to the DMA
+volatile uint32_t tx_done = 0;    // Frames finished (interrupt)
+uint32_t tx_idle_since;           // DWT stamp when the queue ran empty
+bool tx_ready = false;            // Tx_Init done (before it: UARTCharPut)
+
+// Metrics ('D' frame)
+uint32_t m_tx_frames = 0; // Frames sent
+uint32_t m_tx_idle_ms = 0; // Idle line time between frames (ms)
+uint32_t m_tx_gaps = 0;   // Back-to-back frames where the FIFO ran empty
+uint32_t m_tx_waits = 0;  // Producer found every slot full
+uint32_t tx_idle_us = 0;  // Below 1 ms, carried to the next frame
+
+extern uint32_t metrics_cpu_mhz;
+uint32_t Metrics_Wait_Begin(); // metrics.h
+void Metrics_Wait_End(uint32_t start);
+
+// Starts the DMA on the oldest queued frame. UART0 interrupt must be off
+// (it is either running in it, or called with it disabled).
+void Tx_Start_Next(bool back_to_back) {
+    uint32_t slot = tx_started % TX_SLOTS;
+    uint32_t fr = HWREG(UART0_BASE + UART_O_FR);
+
+    if (back_to_back) {
+        if ((fr & UART_FR_TXFE) && !(fr & UART_FR_BUSY)) m_tx_gaps++;
+    } else {
+        tx_idle_us += (HWREG(DWT_CYCCNT) - tx_idle_since) / metrics_cpu_mhz;
+        m_tx_idle_ms += tx_idle_us / 1000;
+        tx_idle_us %= 1000;
+    }
+    uDMAChannelTransferSet(TX_DMA_CH | UDMA_PRI_SELECT, UDMA_MODE_BASIC,
+                           tx_slot[slot], (void *)(UART0_BASE + UART_O_DR), tx_len[slot]);
+    uDMAChannelEnable(TX_DMA_CH);
+    tx_started++;
+}
+
+// UART0 interrupt: on the TM4C123 the uDMA completion of a peripheral
+// channel arrives on the peripheral's own vector
+void Tx_ISR(void) {
+    UARTIntClear(UART0_BASE, UARTIntStatus(UART0_BASE, true));
+    if (tx_started == tx_done || uDMAChannelIsEnabled(TX_DMA_CH)) return; // Still sending
+    tx_done++;
+    m_tx_frames++;
+    if (tx_started != tx_put) Tx_Start_Next(true);
+    else tx_idle_since = HWREG(DWT_CYCCNT);
+}
+
+// uDMA + UART0 DMA request + interrupt. UART0 must already be configured.
+void Tx_Init() {
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_UDMA));
+    uDMAEnable();
+    uDMAControlBaseSet(udma_table);
+
+    uDMAChannelAssign(TX_DMA_CH);
+    uDMAChannelAttributeDisable(TX_DMA_CH, UDMA_ATTR_ALL);
+    uDMAChannelControlSet(TX_DMA_CH | UDMA_PRI_SELECT,
+                          UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_4);
+
+    UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX4_8, UART_FIFO_RX4_8);
+    UARTDMAEnable(UART0_BASE, UART_DMA_TX);
+    UARTIntRegister(UART0_BASE, Tx_ISR);
+    IntEnable(INT_UART0);
+
+    tx_idle_since = HWREG(DWT_CYCCNT);
+    tx_ready = true;
+}
+
+// Buffer for the next frame (at most TX_SLOT_BYTES, terminator included).
+// Waits only if every slot is still queued.
+char *Tx_Reserve() {
+    if (tx_put - tx_done >= TX_SLOTS) {
+        uint32_t w = Metrics_Wait_Begin();
+        m_tx_waits++;
+        while (tx_put - tx_done >= TX_SLOTS);
+        Metrics_Wait_End(w);
+    }
+    return tx_slot[tx_put % TX_SLOTS];
+}
+
+// Queues the reserved frame; returns its number for Tx_Done()
+uint32_t Tx_Commit(uint32_t len) {
+    uint32_t n;
+    if (len == 0) return tx_put;
+    if (len > TX_SLOT_BYTES) len = TX_SLOT_BYTES;
+
+    if (!tx_ready) { // Boot, before Tx_Init: plain FIFO writes
+        const char *p = tx_slot[tx_put % TX_SLOTS];
+        while (len--) UARTCharPut(UART0_BASE, *p++);
+        return tx_put;
+    }
+
+    tx_len[tx_put % TX_SLOTS] = (uint16_t)len;
+    IntDisable(INT_UART0);
+    n = ++tx_put;
+    if (tx_started == tx_done) Tx_Start_Next(false); // Line was idle
+    IntEnable(INT_UART0);
+    return n;
+}
+
+// True once frame 'n' (from Tx_Commit) has been handed to the FIFO
+bool Tx_Done(uint32_t n) {
+    return (int32_t)(tx_done - n) >= 0;
+}
+
+// Nothing queued and the last byte has left the shift register
+bool Tx_Idle() {
+    return tx_done == tx_put && !UARTBusy(UART0_BASE);
+}
+
+// Waits until everything queued has been sent (baud / clock changes).
+// Needs the UART0 interrupt, so call it with interrupts enabled unless
+// the queue is known to be empty.
+void Tx_Flush() {
+    uint32_t w = Metrics_Wait_Begin();
+    while (!Tx_Idle());
+    Metrics_Wait_End(w);
+}
+
+// Copies a string into the queue
+void Tx_Send(const char *str) {
+    uint32_t len = strlen(str);
+    if (len > TX_SLOT_BYTES) len = TX_SLOT_BYTES;
+    memcpy(Tx_Reserve(), str, len);
+    Tx_Commit(len);
+}
+
+#endif